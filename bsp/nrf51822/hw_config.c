@@ -4,6 +4,6 @@ extern char __bss_end__ [];
 
 struct phys_mem system_phys_mem [] =
     {
-        { __bss_end__, (char *) 0x20008000, },
+        { __bss_end__, (char *) 0x20008000, "sram", MEM_ATTR_FAST | MEM_ATTR_DMA, },
         { 0, 0 }
     };
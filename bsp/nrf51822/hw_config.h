@@ -7,4 +7,12 @@
 
 #define RTW_SYS_TICK_HZ         50
 
+#define RTW_SYS_TIMER_FREQ      32768
+
 #define RTW_CONFIG_IRQ_DISPATCH
+
+#define RTW_TIMER_POOL_BLKS     8
+
+#define RTW_EVENT_POOL_BLKS     4
+
+#define RTW_BOOT_ARENA_SIZE     0x800
@@ -11,13 +11,26 @@ modification history
 */
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include <wheel/hal_int.h>
 #include <wheel/hal_timer.h>
 #include <wheel/driver.h>
 
+/* defines */
+
+#define RTC_MAX_COUNT           0xffffff
+
 static const unsigned int rtc_irq [2] = {11, 17};
 
+/*
+the counter is free running, instead of clearing it in the isr (which loses the
+isr latency every period), cc [0] is moved on by one period at each compare, so
+the period is exact and the counter can be used as a monotonic time base.
+*/
+
+static uint32_t rtc_period [2];
+
 static struct
     {
     volatile uint32_t  tasks_hfclkstart;
@@ -79,9 +92,42 @@ static struct
     volatile uint32_t  power;
     } * const nrf_rtc [2] = {(void *) 0x4000b000, (void *) 0x40001100};
 
+static inline bool __rtc_cc0_missed (uint8_t unit)
+    {
+    uint32_t delta = (nrf_rtc [unit]->cc [0] - nrf_rtc [unit]->counter) &
+                     RTC_MAX_COUNT;
+
+    /* the rtc misses a compare value less than counter + 2 */
+
+    return (delta < 2) || (delta > rtc_period [unit]);
+    }
+
 static void rtc_handler (uintptr_t arg)
     {
     hal_timer_t * timer = (hal_timer_t *) arg;
+    uint8_t       chan;
+
+    /* the spare channels use cc [1] and up */
+
+    for (chan = 0; chan < timer->nr_chans; chan++)
+        {
+        if (!nrf_rtc [timer->unit]->events_compare [chan + 1])
+            {
+            continue;
+            }
+
+        nrf_rtc [timer->unit]->events_compare [chan + 1] = 0;
+
+        /* one-shot, the handler may enable it again */
+
+        nrf_rtc [timer->unit]->intenclr = 1 << (17 + chan);
+        nrf_rtc [timer->unit]->evtenclr = 1 << (17 + chan);
+
+        if (timer->chans [chan].handler != NULL)
+            {
+            timer->chans [chan].handler (timer->chans [chan].arg);
+            }
+        }
 
     if (!nrf_rtc [timer->unit]->events_compare [0])
         {
@@ -89,16 +135,26 @@ static void rtc_handler (uintptr_t arg)
         }
 
     nrf_rtc [timer->unit]->events_compare [0] = 0;  /* clear event */
-    nrf_rtc [timer->unit]->tasks_clear        = 1;  /* clear counter */
 
-    timer->handler (timer->arg);
+    /* move on to the next period, catch up the periods missed if any */
+
+    do
+        {
+        nrf_rtc [timer->unit]->cc [0] = (nrf_rtc [timer->unit]->cc [0] +
+                                         rtc_period [timer->unit]) & RTC_MAX_COUNT;
+
+        timer->handler (timer->arg);
+        } while (__rtc_cc0_missed (timer->unit));
     }
 
 static int rtc_enable (hal_timer_t * this, uint64_t max_count)
     {
     hal_timer_t * timer = (hal_timer_t *) this;
 
-    nrf_rtc [timer->unit]->cc [0]   = max_count;
+    rtc_period [timer->unit]           = (uint32_t) max_count;
+
+    nrf_rtc [timer->unit]->tasks_clear = 1;
+    nrf_rtc [timer->unit]->cc [0]      = max_count;
 
     nrf_rtc [timer->unit]->evten    = 1 << 16;  /* compare0 event enable */
     nrf_rtc [timer->unit]->intenset = 1 << 16;  /* compare0 int enable */
@@ -136,17 +192,60 @@ static uint64_t rtc_counter (hal_timer_t * this)
     return (uint64_t) nrf_rtc [timer->unit]->counter;
     }
 
+static int rtc_chan_enable (hal_timer_t * this, uint8_t chan, uint64_t cmp)
+    {
+    hal_timer_t * timer   = (hal_timer_t *) this;
+    uint32_t      counter = nrf_rtc [timer->unit]->counter;
+    uint32_t      delta   = ((uint32_t) cmp - counter) & RTC_MAX_COUNT;
+
+    /*
+     * the rtc misses a compare value less than counter + 2, a value in the past
+     * (more than half the range ahead) is due already
+     */
+
+    if ((delta < 2) || (delta > (RTC_MAX_COUNT >> 1)))
+        {
+        cmp = (counter + 2) & RTC_MAX_COUNT;
+        }
+
+    nrf_rtc [timer->unit]->intenclr                  = 1 << (17 + chan);
+    nrf_rtc [timer->unit]->cc [chan + 1]             = (uint32_t) cmp;
+    nrf_rtc [timer->unit]->events_compare [chan + 1] = 0;
+    nrf_rtc [timer->unit]->evtenset                  = 1 << (17 + chan);
+    nrf_rtc [timer->unit]->intenset                  = 1 << (17 + chan);
+
+    return 0;
+    }
+
+static int rtc_chan_disable (hal_timer_t * this, uint8_t chan)
+    {
+    hal_timer_t * timer = (hal_timer_t *) this;
+
+    nrf_rtc [timer->unit]->intenclr                  = 1 << (17 + chan);
+    nrf_rtc [timer->unit]->evtenclr                  = 1 << (17 + chan);
+    nrf_rtc [timer->unit]->events_compare [chan + 1] = 0;
+
+    return 0;
+    }
+
 
 static int rtc_init (void)
     {
     static const hal_timer_methods_t rtc_methods =
         {
-        .enable    = rtc_enable,
-        .disable   = rtc_disable,
-        .connect   = rtc_connect,
-        .counter   = rtc_counter
+        .enable       = rtc_enable,
+        .disable      = rtc_disable,
+        .connect      = rtc_connect,
+        .counter      = rtc_counter,
+        .chan_enable  = rtc_chan_enable,
+        .chan_disable = rtc_chan_disable
         };
 
+    /* rtc0 has 3 compare channels, rtc1 has 4, cc [0] is used for the period */
+
+    static hal_timer_chan_t rtc0_chans [2];
+    static hal_timer_chan_t rtc1_chans [3];
+
     static hal_timer_t rtc_timer [2] =
         {
             {
@@ -155,7 +254,10 @@ static int rtc_init (void)
             .busy      = 0,
             .down      = false,
             .freq      = 32768,
-            .max_count = 0xffffff,
+            .max_count = RTC_MAX_COUNT,
+            .free_run  = true,
+            .nr_chans  = 2,
+            .chans     = rtc0_chans,
             .methods   = &rtc_methods
             },
             {
@@ -164,7 +266,10 @@ static int rtc_init (void)
             .busy      = 0,
             .down      = false,
             .freq      = 32768,
-            .max_count = 0xffffff,
+            .max_count = RTC_MAX_COUNT,
+            .free_run  = true,
+            .nr_chans  = 3,
+            .chans     = rtc1_chans,
             .methods   = &rtc_methods
             },
         };
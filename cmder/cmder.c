@@ -262,6 +262,18 @@ typedef struct tire_node
 
 static dlist_t          cmd_root = DLIST_INIT (cmd_root);
 
+/*
+ * trie nodes are never freed, take them from a static array before going to
+ * the heap, no chunk header and no heap locking for every character
+ */
+
+#ifndef RTW_CMDER_TIRE_NODES
+#define RTW_CMDER_TIRE_NODES    64
+#endif
+
+static tire_node_t      cmd_nodes [RTW_CMDER_TIRE_NODES];
+static unsigned int     cmd_nodes_used = 0;
+
 #else
 
 static cmder_cmd_t    * cmder_cmds;
@@ -560,7 +572,19 @@ void cmder_register (const cmder_cmd_t * cmd)
 
     do
         {
-        node = (tire_node_t *) malloc (sizeof (tire_node_t));
+        if (cmd_nodes_used < RTW_CMDER_TIRE_NODES)
+            {
+            node = &cmd_nodes [cmd_nodes_used++];
+            }
+        else
+            {
+            node = (tire_node_t *) malloc (sizeof (tire_node_t));
+            }
+
+        if (node == NULL)
+            {
+            return;
+            }
 
         node->ch     = *left;
         node->parent = match;
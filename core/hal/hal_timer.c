@@ -110,6 +110,85 @@ uint64_t hal_timer_counter (hal_timer_t * timer)
     return counter;
     }
 
+static inline bool __chan_valid (hal_timer_t * timer, uint8_t chan)
+    {
+    if (!timer || !timer->methods || !timer->methods->chan_enable ||
+        !timer->methods->chan_disable)
+        {
+        return false;
+        }
+
+    return chan < timer->nr_chans;
+    }
+
+/**
+ * hal_timer_chan_enable - enable a spare compare channel of a timer, the
+ *                         channel fires once when the counter reach <cmp>
+ * @timer: the timer
+ * @chan:  the channel number
+ * @cmp:   the compare value
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int hal_timer_chan_enable (hal_timer_t * timer, uint8_t chan, uint64_t cmp)
+    {
+    if (!__chan_valid (timer, chan))
+        {
+        return -1;
+        }
+
+    if (cmp > timer->max_count)
+        {
+        return -1;
+        }
+
+    return timer->methods->chan_enable (timer, chan, cmp);
+    }
+
+/**
+ * hal_timer_chan_disable - disable a spare compare channel of a timer
+ * @timer: the timer
+ * @chan:  the channel number
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int hal_timer_chan_disable (hal_timer_t * timer, uint8_t chan)
+    {
+    if (!__chan_valid (timer, chan))
+        {
+        return -1;
+        }
+
+    return timer->methods->chan_disable (timer, chan);
+    }
+
+/**
+ * hal_timer_chan_connect - connect a callback routine to a spare compare
+ *                          channel of a timer, invoked in the timer isr
+ * @timer: the timer
+ * @chan:  the channel number
+ * @pfn:   the callback routine
+ * @arg:   the argument to the callback routine
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int hal_timer_chan_connect (hal_timer_t * timer, uint8_t chan,
+                            void (* pfn) (uintptr_t), uintptr_t arg)
+    {
+    if (!__chan_valid (timer, chan))
+        {
+        return -1;
+        }
+
+    timer->chans [chan].handler = pfn;
+    timer->chans [chan].arg     = arg;
+
+    return 0;
+    }
+
 /**
  * hal_timer_register - register a timer to the hal
  * @timer: the timer to register
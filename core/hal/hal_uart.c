@@ -15,7 +15,6 @@ modification history
 
 #include <wheel/common.h>
 #include <wheel/hal_uart.h>
-#include <wheel/irq.h>
 
 #include <kernel/mutex.h>
 
@@ -93,31 +92,22 @@ size_t hal_uart_poll_read (hal_uart_t * uart, unsigned char * buff, size_t len)
 static inline size_t __uart_getc (hal_uart_t * uart, unsigned char * buff,
                                   unsigned int timeout)
     {
-    unsigned long flags = 0;
-    size_t        ret;
+    size_t ret;
 
     if (sem_timedwait (&uart->rxsem, timeout) != 0)
         {
         return 0;
         }
 
+    /* the readers are serialized by rxmux, the rx-ISR is the only producer */
+
     if (mutex_timedlock (&uart->rxmux, timeout) != 0)
         {
         sem_post (&uart->rxsem);
         return 0;
         }
 
-    if (!uart->deferred_isr)
-        {
-        flags = int_lock ();
-        }
-
-    ret = ring_getc (uart->rxring, buff);
-
-    if (!uart->deferred_isr)
-        {
-        int_unlock (flags);
-        }
+    ret = ring_spsc_getc (uart->rxring, buff);
 
     mutex_unlock (&uart->rxmux);
 
@@ -192,42 +182,36 @@ size_t hal_uart_poll_write (hal_uart_t * uart, unsigned char * buff, size_t len)
 static inline size_t __uart_putc (hal_uart_t * uart, unsigned char ch,
                                   unsigned int timeout)
     {
-    unsigned long flags = 0;
-    size_t        ret;
-    bool          empty;
+    size_t ret;
 
     if (sem_timedwait (&uart->txsem, timeout) != 0)
         {
         return 0;
         }
 
+    /* the writers are serialized by txmux, the tx-ISR is the only consumer */
+
     if (mutex_timedlock (&uart->txmux, timeout) != 0)
         {
         sem_post (&uart->txsem);
         return 0;
         }
 
-    if (!uart->deferred_isr)
-        {
-        flags = int_lock ();
-        }
+    ret = ring_spsc_putc (uart->txring, ch);
 
-    empty = ring_empty (uart->txring);
+    /*
+     * the tx-ISR stops when it finds the ring empty, and it can only find it
+     * empty before this char is published, so (re)start it if this char may be
+     * the only one left, tx_start when the tx-ISR is still running is harmless
+     */
 
-    ret = ring_putc (uart->txring, ch);
-
-    if (!uart->deferred_isr)
+    if (ring_spsc_len (uart->txring) <= 1)
         {
-        int_unlock (flags);
+        uart->methods->tx_start (uart);
         }
 
     mutex_unlock (&uart->txmux);
 
-    if (empty)
-        {
-        uart->methods->tx_start (uart);
-        }
-
     return ret;
     }
 
@@ -274,24 +258,10 @@ size_t hal_uart_write (hal_uart_t * uart, unsigned char * buff, size_t len)
 
 void hal_rx_putc (hal_uart_t * uart, unsigned char ch)
     {
-    struct ring * ring = uart->rxring;
-    bool          full;
-
-    if (uart->deferred_isr)
-        {
-        mutex_lock (&uart->rxmux);
-        }
 
-    full = ring_full (ring);
-
-    ring_putc_force (ring, ch);
-
-    if (uart->deferred_isr)
-        {
-        mutex_unlock (&uart->rxmux);
-        }
+    /* the char is dropped if the rxring is full, the consumer owns the head */
 
-    if (!full)
+    if (ring_spsc_putc (uart->rxring, ch) != 0)
         {
         sem_post (&uart->rxsem);
         }
@@ -307,20 +277,7 @@ void hal_rx_putc (hal_uart_t * uart, unsigned char ch)
 
 size_t hal_tx_getc (hal_uart_t * uart, unsigned char * ch)
     {
-    size_t        ret;
-    struct ring * ring = uart->txring;
-
-    if (uart->deferred_isr)
-        {
-        mutex_lock (&uart->txmux);
-        }
-
-    ret = ring_empty (ring) ? 0 : ring_getc (ring, ch);
-
-    if (uart->deferred_isr)
-        {
-        mutex_unlock (&uart->txmux);
-        }
+    size_t ret = ring_spsc_getc (uart->txring, ch);
 
     if (ret != 0)
         {
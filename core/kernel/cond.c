@@ -0,0 +1,195 @@
+/* cond.c - condition variable library */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+cond_wait unlocks the mutex and pends on the condition variable in one critical
+job, so no signal can be lost in between. a signaled waiter is not waked up to
+fight for the mutex, it is moved to the pend queue of the mutex directly (or
+given the mutex if it is free), so it will be waked up only once, with the
+mutex locked. a waiter timed out is requeued on the mutex the same way in the
+tick callback, so it does not need to lock the mutex again after waked up.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#include <wheel/common.h>
+
+#include <kernel/cond.h>
+#include <kernel/critical.h>
+
+/* externs */
+
+extern int __mutex_unlock (uintptr_t arg1, uintptr_t arg2);
+
+/* typedefs */
+
+struct cond_wait_ctx
+    {
+    cond_id      cond;
+    mutex_id     mutex;
+    unsigned int timeout;
+    };
+
+/**
+ * cond_init - initialize a condition variable
+ * @cond: the condition variable to be initialized
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int cond_init (cond_id cond)
+    {
+    if (cond == NULL)
+        {
+        return -1;
+        }
+
+    cond->mutex = NULL;
+
+    pwait_q_init (&cond->pend_q);
+
+    return 0;
+    }
+
+static void __tick_q_callback_cond (task_id task)
+    {
+    mutex_relock_for (task->cond_mutex, task);
+    }
+
+static int __cond_wait (uintptr_t arg1, uintptr_t arg2)
+    {
+    struct cond_wait_ctx * ctx   = (struct cond_wait_ctx *) arg1;
+    cond_id                cond  = ctx->cond;
+    mutex_id               mutex = ctx->mutex;
+
+    (void) arg2;
+
+    /* the mutex must be locked (not recursively) by current */
+
+    if ((current == NULL) || (mutex->owner != current) || (mutex->recurse != 1))
+        {
+        return -1;
+        }
+
+    /* all the waiters must use the same mutex */
+
+    if (!pwait_q_empty (&cond->pend_q) && (cond->mutex != mutex))
+        {
+        return -1;
+        }
+
+    cond->mutex         = mutex;
+    current->cond_mutex = mutex;
+
+    (void) __mutex_unlock ((uintptr_t) mutex, 0);
+
+    task_pwait_q_add (&cond->pend_q, ctx->timeout, __tick_q_callback_cond);
+
+    return 0;
+    }
+
+/**
+ * cond_timedwait - wait on a condition variable with timeout
+ * @cond:    the condition variable
+ * @mutex:   the mutex locked by current task
+ * @timeout: the max number of waiting ticks
+ *
+ * return: 0 on success, negtive value on error or timeout, the mutex is still
+ *         locked when return, the timed out task is waked up with the mutex
+ *         locked too
+ */
+
+int cond_timedwait (cond_id cond, mutex_id mutex, unsigned int timeout)
+    {
+    struct cond_wait_ctx ctx;
+
+    if ((cond == NULL) || (mutex == NULL) || (timeout == 0))
+        {
+        return -1;
+        }
+
+    ctx.cond    = cond;
+    ctx.mutex   = mutex;
+    ctx.timeout = timeout;
+
+    return do_critical_might_sleep (__cond_wait, (uintptr_t) &ctx, 0);
+    }
+
+/**
+ * cond_wait - wait on a condition variable
+ * @cond:  the condition variable
+ * @mutex: the mutex locked by current task
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int cond_wait (cond_id cond, mutex_id mutex)
+    {
+    return cond_timedwait (cond, mutex, UINT_MAX);
+    }
+
+static int __cond_signal (uintptr_t arg1, uintptr_t arg2)
+    {
+    cond_id cond = (cond_id) arg1;
+    bool    all  = (bool) arg2;
+    task_id task;
+
+    while ((task = pwait_q_first (&cond->pend_q)) != NULL)
+        {
+        mutex_lock_for (cond->mutex, task);
+
+        if (!all)
+            {
+            break;
+            }
+        }
+
+    return 0;
+    }
+
+/**
+ * cond_signal - wake up the highest priority task waiting on a condition
+ *               variable
+ * @cond: the condition variable
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int cond_signal (cond_id cond)
+    {
+    if (cond == NULL)
+        {
+        return -1;
+        }
+
+    return do_critical (__cond_signal, (uintptr_t) cond, (uintptr_t) false);
+    }
+
+/**
+ * cond_broadcast - wake up all the tasks waiting on a condition variable
+ * @cond: the condition variable
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int cond_broadcast (cond_id cond)
+    {
+    if (cond == NULL)
+        {
+        return -1;
+        }
+
+    return do_critical (__cond_signal, (uintptr_t) cond, (uintptr_t) true);
+    }
@@ -17,6 +17,7 @@ modification history
 #include <wheel/irq.h>
 
 #include <kernel/task.h>
+#include <kernel/critical.h>
 
 #include <arch/sync.h>
 
@@ -216,3 +217,63 @@ int do_critical_non_irq (int (* job) (uintptr_t, uintptr_t),
     return __do_critical (job, arg1, arg2);
     }
 
+static int __do_critical_batch (uintptr_t arg1, uintptr_t arg2)
+    {
+    kbatch_t   * batch = (kbatch_t *) arg1;
+    unsigned int i;
+    int          ret   = 0;
+
+    (void) arg2;
+
+    for (i = 0; i < batch->nr; i++)
+        {
+        if (batch->jobs [i].pfn (batch->jobs [i].arg1, batch->jobs [i].arg2))
+            {
+            ret = -1;
+            }
+        }
+
+    return ret;
+    }
+
+/**
+ * do_critical_batch - do a batch of critical jobs under one critical entry,
+ *                     with only one reschedule at the end, can be invoked in
+ *                     all context
+ * @batch: the jobs, can be reused when return
+ *
+ * return: 0 if all the jobs done (or queued) successfully, negtive value if
+ *         any job failed
+ */
+
+int do_critical_batch (kbatch_t * batch)
+    {
+    unsigned int i;
+    int          ret = 0;
+
+    if (batch->nr == 0)
+        {
+        return 0;
+        }
+
+    /*
+     * the batch may be on the stack of an irq handler and may be gone when the
+     * critical job queue is processed, so queue the jobs one by one
+     */
+
+    if (in_critical)
+        {
+        for (i = 0; i < batch->nr; i++)
+            {
+            if (critical_job_q_add (batch->jobs [i].pfn, batch->jobs [i].arg1,
+                                    batch->jobs [i].arg2))
+                {
+                ret = -1;
+                }
+            }
+
+        return ret;
+        }
+
+    return __do_critical (__do_critical_batch, (uintptr_t) batch, 0);
+    }
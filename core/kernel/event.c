@@ -15,10 +15,29 @@ modification history
 
 #include <wheel/common.h>
 #include <wheel/list.h>
+#include <wheel/config.h>
 
 #include <kernel/event.h>
 #include <kernel/task.h>
 #include <kernel/critical.h>
+#include <kernel/select.h>
+#include <kernel/pool.h>
+
+/* defines */
+
+#ifndef RTW_EVENT_POOL_BLKS
+#define RTW_EVENT_POOL_BLKS     0
+#endif
+
+/* locals */
+
+#if RTW_EVENT_POOL_BLKS > 0
+
+/* event_create takes events from this pool first, then the heap */
+
+POOL_DEF (event_pool, sizeof (event_t), RTW_EVENT_POOL_BLKS);
+
+#endif
 
 /**
  * event_init - initialize an event
@@ -36,6 +55,7 @@ int event_init (event_id event)
 
     event->event_set = 0;
     dlist_init (&event->pend_q);
+    dlist_init (&event->sel_q);
 
     return 0;
     }
@@ -48,7 +68,16 @@ int event_init (event_id event)
 
 event_id event_create (void)
     {
-    event_id event = (event_id) malloc (sizeof (event_t));
+    event_id event = NULL;
+
+#if RTW_EVENT_POOL_BLKS > 0
+    event = (event_id) pool_alloc (&event_pool);
+#endif
+
+    if (event == NULL)
+        {
+        event = (event_id) malloc (sizeof (event_t));
+        }
 
     if (event == NULL)
         {
@@ -57,6 +86,7 @@ event_id event_create (void)
 
     event->event_set = 0;
     dlist_init (&event->pend_q);
+    dlist_init (&event->sel_q);
 
     return event;
     }
@@ -145,7 +175,7 @@ int event_recv (event_id event, uint32_t wanted, uint32_t option,
     return 0;
     }
 
-static int __event_send (uintptr_t arg1, uintptr_t arg2)
+int __event_send (uintptr_t arg1, uintptr_t arg2)
     {
     event_id  event  = (event_id) arg1;
     uint32_t  events = (uint32_t) arg2;
@@ -170,6 +200,11 @@ static int __event_send (uintptr_t arg1, uintptr_t arg2)
             }
         }
 
+    if (event->event_set != 0)
+        {
+        kobj_sel_notify (&event->sel_q);
+        }
+
     return 0;
     }
 
@@ -0,0 +1,359 @@
+/* hrtimer.c - high resolution timer library */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+the hrtimers are one-shot, kept in a queue sorted by the expiry in system clock
+cycles, only the head is armed on the system clock alarm, which is multiplexed
+on a spare compare channel of the system timer. when the alarm fires, all the
+expired hrtimers are called back in critical (like the tick timers) and the
+alarm is re-armed for the new head.
+
+the resolution is the one of the system timer, for the nrf51 rtc it is one cycle
+of 32768 hz, about 30.5 us.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#include <wheel/common.h>
+#include <wheel/sysclk.h>
+
+#include <kernel/hrtimer.h>
+#include <kernel/task.h>
+#include <kernel/critical.h>
+
+/* typedefs */
+
+struct hrtimer_wait
+    {
+    hrtimer_t    timer;
+    task_id      task;
+    int       (* job) (uintptr_t, uintptr_t);
+    uintptr_t    arg;
+    void      (* on_timeout) (task_id);
+    };
+
+/* locals */
+
+static dlist_t hrtimer_q        = DLIST_INIT (hrtimer_q);
+static bool    hrtimer_attached = false;
+
+static void __hrtimer_alarm (uintptr_t arg);
+
+/**
+ * hrtimer_init - initialize a hrtimer
+ * @timer: the hrtimer to be initialized
+ * @pfn:   timeout callback, invoked in critical
+ * @arg:   the argument for the timeout callback
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int hrtimer_init (hrtimer_id timer, void (* pfn) (uintptr_t), uintptr_t arg)
+    {
+    if ((timer == NULL) || (pfn == NULL))
+        {
+        return -1;
+        }
+
+    timer->active = false;
+    timer->expiry = 0;
+    timer->wanted = 0;
+    timer->pfn    = pfn;
+    timer->arg    = arg;
+
+    dlist_init (&timer->node);
+
+    return 0;
+    }
+
+/**
+ * __hrtimer_rearm - arm the system clock alarm for the head of the queue
+ *
+ * return: NA
+ */
+
+static void __hrtimer_rearm (void)
+    {
+    if (dlist_empty (&hrtimer_q))
+        {
+        sysclk_alarm_cancel ();
+        }
+    else
+        {
+        sysclk_alarm_set (container_of (hrtimer_q.next, hrtimer_t, node)->expiry);
+        }
+    }
+
+static void __hrtimer_alarm (uintptr_t arg)
+    {
+    uint64_t   now = sysclk_cycles ();
+    hrtimer_id timer;
+
+    (void) arg;
+
+    while (!dlist_empty (&hrtimer_q))
+        {
+        timer = container_of (hrtimer_q.next, hrtimer_t, node);
+
+        if (timer->expiry > now)
+            {
+            break;
+            }
+
+        dlist_del (&timer->node);
+
+        timer->active = false;
+
+        /* prevent task switch in user timer callback */
+
+        task_lock_cnt++;
+
+        timer->pfn (timer->arg);
+
+        task_lock_cnt--;
+        }
+
+    __hrtimer_rearm ();
+    }
+
+static void __hrtimer_del (hrtimer_id timer)
+    {
+    bool head = hrtimer_q.next == &timer->node;
+
+    dlist_del (&timer->node);
+
+    timer->active = false;
+
+    if (head)
+        {
+        __hrtimer_rearm ();
+        }
+    }
+
+static int __hrtimer_start (uintptr_t arg1, uintptr_t arg2)
+    {
+    hrtimer_id timer = (hrtimer_id) arg1;
+    dlist_t  * itr;
+
+    (void) arg2;
+
+    if (!hrtimer_attached)
+        {
+        if (sysclk_alarm_connect (__hrtimer_alarm, 0) != 0)
+            {
+            return -1;
+            }
+
+        hrtimer_attached = true;
+        }
+
+    if (timer->active)
+        {
+        __hrtimer_del (timer);
+        }
+
+    timer->expiry = timer->wanted;
+    timer->active = true;
+
+    /* search from the tail, the later one is inserted after the earlier ones */
+
+    for (itr = hrtimer_q.prev; itr != &hrtimer_q; itr = itr->prev)
+        {
+        if (container_of (itr, hrtimer_t, node)->expiry <= timer->expiry)
+            {
+            break;
+            }
+        }
+
+    dlist_add (itr, &timer->node);
+
+    if (hrtimer_q.next == &timer->node)
+        {
+        __hrtimer_rearm ();
+        }
+
+    return 0;
+    }
+
+/**
+ * hrtimer_us2cycles - convert microseconds to system clock cycles, rounded up
+ * @us: the microseconds
+ *
+ * return: the number of cycles
+ */
+
+uint64_t hrtimer_us2cycles (uint32_t us)
+    {
+    uint64_t cycles = sysclk_us_to_cycles (us);
+
+    /* never expire earlier than asked */
+
+    if (sysclk_cycles_to_us (cycles) < us)
+        {
+        cycles++;
+        }
+
+    return cycles;
+    }
+
+/**
+ * hrtimer_start_at - start a hrtimer to expire at an absolute cycle count
+ * @timer:  the hrtimer to be started
+ * @cycles: the expiry, in system clock cycles got from sysclk_cycles
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int hrtimer_start_at (hrtimer_id timer, uint64_t cycles)
+    {
+    if (timer == NULL)
+        {
+        return -1;
+        }
+
+    /* the job may be deferred if invoked in isr, so not pass it on the stack */
+
+    timer->wanted = cycles;
+
+    return do_critical (__hrtimer_start, (uintptr_t) timer, 0);
+    }
+
+/**
+ * hrtimer_start - start a hrtimer to expire after <us> microseconds, restart
+ *                 it if already started
+ * @timer: the hrtimer to be started
+ * @us:    the microseconds to expire
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int hrtimer_start (hrtimer_id timer, uint32_t us)
+    {
+    return hrtimer_start_at (timer, sysclk_cycles () + hrtimer_us2cycles (us));
+    }
+
+static int __hrtimer_cancel (uintptr_t arg1, uintptr_t arg2)
+    {
+    hrtimer_id timer = (hrtimer_id) arg1;
+
+    (void) arg2;
+
+    if (timer->active)
+        {
+        __hrtimer_del (timer);
+        }
+
+    return 0;
+    }
+
+/**
+ * hrtimer_cancel - cancel a hrtimer
+ * @timer: the hrtimer to be canceled
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int hrtimer_cancel (hrtimer_id timer)
+    {
+    if (timer == NULL)
+        {
+        return -1;
+        }
+
+    return do_critical (__hrtimer_cancel, (uintptr_t) timer, 0);
+    }
+
+static void __hrtimer_wait_timeout (uintptr_t arg)
+    {
+    struct hrtimer_wait * wait = (struct hrtimer_wait *) arg;
+    task_id               task = wait->task;
+
+    /* the task may have been woken up just before */
+
+    if (!(task->status & TASK_STATUS_PEND))
+        {
+        return;
+        }
+
+    task_retval_set (task, -1);
+    task_ready_q_add (task);
+
+    if (wait->on_timeout != NULL)
+        {
+        wait->on_timeout (task);
+        }
+    }
+
+static int __hrtimer_wait (uintptr_t arg1, uintptr_t arg2)
+    {
+    struct hrtimer_wait * wait = (struct hrtimer_wait *) arg1;
+    int                   ret;
+
+    (void) arg2;
+
+    wait->task = current;
+
+    ret = wait->job (wait->arg, UINT_MAX);
+
+    if ((ret == 0) && (current != NULL) && (current->status & TASK_STATUS_PEND))
+        {
+        wait->timer.wanted += sysclk_cycles ();
+
+        (void) __hrtimer_start ((uintptr_t) &wait->timer, 0);
+        }
+
+    return ret;
+    }
+
+/**
+ * hrtimer_wait - run a pending job (like __sem_wait) with a timeout in
+ *                microseconds, the job is invoked with the timeout of UINT_MAX,
+ *                and an on-stack hrtimer wakes the task up if it is still
+ *                pending when expired
+ * @job:        the job, same as the ones for do_critical_might_sleep
+ * @arg:        the first argument to the job
+ * @us:         the max number of waiting microseconds, 0 for no waiting
+ * @on_timeout: the callback to fix up the object the task pending on when
+ *              timeout, same as the one passed to task_pwait_q_add, can be NULL
+ *
+ * return: the return value of the job, negtive value on error or timeout
+ */
+
+int hrtimer_wait (int (* job) (uintptr_t, uintptr_t), uintptr_t arg,
+                  uint32_t us, void (* on_timeout) (task_id))
+    {
+    struct hrtimer_wait wait;
+    int                 ret;
+
+    if (us == 0)
+        {
+        return do_critical_non_irq (job, arg, 0);
+        }
+
+    (void) hrtimer_init (&wait.timer, __hrtimer_wait_timeout, (uintptr_t) &wait);
+
+    wait.job          = job;
+    wait.arg          = arg;
+    wait.on_timeout   = on_timeout;
+    wait.timer.wanted = hrtimer_us2cycles (us);
+
+    ret = do_critical_might_sleep (__hrtimer_wait, (uintptr_t) &wait, 0);
+
+    /* the hrtimer is on stack, it must be out of the queue before returning */
+
+    (void) do_critical_non_irq (__hrtimer_cancel, (uintptr_t) &wait.timer, 0);
+
+    return ret;
+    }
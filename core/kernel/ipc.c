@@ -0,0 +1,545 @@
+/* ipc.c - synchronous ipc library */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+a client calls an endpoint with a request and blocks until a server replies,
+the request is copied directly from the client buffer to the buffer of the
+server, and the reply is copied directly to the buffer of the client, no
+intermediate message queue.
+
+when a call is delivered, the server inherits the priority of the client and
+the tick slices left of the client (its own slices are saved in the call), the
+server is put at the head of the ready queue, so it will just run in place of
+the client. when replying, the client gets the tick slices back, the server
+gets its own slices back, and the client is put at the head of the ready queue,
+so it will run as soon as the server pends in ipc_receive again.
+
+a call is taken by the first waiting server with a buffer big enough for the
+request, and a server takes the highest priority waiting call that fits its
+buffer. the calls too long for all the waiting servers are left pending, until
+a server with a bigger buffer comes or they timeout.
+
+a server keeps the priority of all the clients it received but not replied, so
+a server can receive more than one calls before replying. the priority of the
+clients pending on an endpoint is not passed to the servers busy on other
+calls, as it is unknown which server will take the call.
+
+when a server is deleted, the clients waiting for its replies are waked up with
+-1, when a client is deleted in a call, the call is taken back from the server
+and a later ipc_reply to it fails.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <limits.h>
+
+#include <wheel/common.h>
+
+#include <kernel/ipc.h>
+#include <kernel/mutex.h>
+#include <kernel/critical.h>
+
+/* typedefs */
+
+struct ipc_reply_ctx
+    {
+    struct ipc_call * call;
+    const void      * buff;
+    size_t            size;
+    };
+
+/**
+ * ipc_ep_init - initialize an ipc endpoint
+ * @ep: the endpoint to be initialized
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int ipc_ep_init (ipc_ep_id ep)
+    {
+    if (ep == NULL)
+        {
+        return -1;
+        }
+
+    dlist_init (&ep->servers);
+    pwait_q_init (&ep->callers);
+
+    return 0;
+    }
+
+/**
+ * __ipc_deliver - deliver a call to a server, the server inherits the priority
+ *                 and the tick slices of the client
+ * @call:   the call
+ * @server: the server task
+ * @recv:   the receiving of the server
+ *
+ * return: NA
+ */
+
+static void __ipc_deliver (struct ipc_call * call, task_id server,
+                           struct ipc_recv * recv)
+    {
+    memcpy (recv->buff, call->req, call->req_size);
+
+    recv->call   = call;
+    call->server = server;
+
+    dlist_add_tail (&server->ipc_served, &call->node);
+
+    /* the slices of the server are given back on reply */
+
+    call->slices        = server->tick_slices;
+    server->tick_slices = call->client->tick_slices;
+
+    task_prio_inherit (server, call->client->c_prio);
+    }
+
+/**
+ * __ipc_server_find - find the first server pending on an endpoint with a
+ *                     buffer big enough for a request
+ * @ep:   the endpoint
+ * @size: size of the request
+ *
+ * return: the server, or NULL if no server fits
+ */
+
+static task_id __ipc_server_find (ipc_ep_id ep, size_t size)
+    {
+    dlist_t * itr;
+    task_id   server;
+
+    dlist_foreach (itr, &ep->servers)
+        {
+        server = container_of (itr, task_t, pq_node);
+
+        if (size <= server->ipc_recv->size)
+            {
+            return server;
+            }
+        }
+
+    return NULL;
+    }
+
+/**
+ * __ipc_client_find - find the highest priority client pending on an endpoint
+ *                     with a request fits the buffer of a server
+ * @ep:   the endpoint
+ * @size: size of the buffer of the server
+ *
+ * return: the client, or NULL if no client fits
+ */
+
+static task_id __ipc_client_find (ipc_ep_id ep, size_t size)
+    {
+    dlist_t * itr;
+    task_id   client;
+
+    dlist_foreach (itr, &ep->callers.tasks)
+        {
+        client = container_of (itr, task_t, pq_node);
+
+        if (client->ipc_call->req_size <= size)
+            {
+            return client;
+            }
+        }
+
+    return NULL;
+    }
+
+static void __tick_q_callback_ipc_call (task_id task)
+    {
+    task->ipc_call = NULL;
+    }
+
+static int __ipc_call (uintptr_t arg1, uintptr_t arg2)
+    {
+    struct ipc_call * call    = (struct ipc_call *) arg1;
+    unsigned int      timeout = (unsigned int) arg2;
+    ipc_ep_id         ep      = call->ep;
+    struct ipc_recv * recv;
+    task_id           server;
+
+    if (current == NULL)
+        {
+        return -1;
+        }
+
+    call->client = current;
+    call->server = NULL;
+
+    dlist_init (&call->reply_q);
+
+    /* pend if no server is waiting with a buffer big enough */
+
+    if ((server = __ipc_server_find (ep, call->req_size)) == NULL)
+        {
+        if (timeout == 0)
+            {
+            return -1;
+            }
+
+        current->ipc_call = call;
+
+        task_pwait_q_add (&ep->callers, timeout, __tick_q_callback_ipc_call);
+
+        return 0;
+        }
+
+    recv = server->ipc_recv;
+
+    current->ipc_call = call;
+    server->ipc_recv  = NULL;
+
+    __ipc_deliver (call, server, recv);
+
+    task_retval_set (server, (int) call->req_size);
+
+    /* let the server run in place */
+
+    task_ready_q_ins (server);
+
+    task_fwait_q_add (&call->reply_q, UINT_MAX, NULL);
+
+    return 0;
+    }
+
+/**
+ * ipc_timedcall - call an endpoint and wait for the reply with timeout
+ * @ep:       the endpoint
+ * @req:      the request
+ * @req_size: size of the request
+ * @rsp:      the buffer for the reply
+ * @rsp_size: size of the reply buffer
+ * @timeout:  the max number of ticks waiting for a server to receive, once
+ *            received, the client waits for the reply forever
+ *
+ * return: size of the reply on success, negtive value on error or timeout
+ */
+
+int ipc_timedcall (ipc_ep_id ep, const void * req, size_t req_size,
+                   void * rsp, size_t rsp_size, unsigned int timeout)
+    {
+    struct ipc_call call;
+
+    if ((ep == NULL) || ((req == NULL) && (req_size != 0)) ||
+        ((rsp == NULL) && (rsp_size != 0)))
+        {
+        return -1;
+        }
+
+    call.ep       = ep;
+    call.req      = req;
+    call.req_size = req_size;
+    call.rsp      = rsp;
+    call.rsp_size = rsp_size;
+
+    return do_critical_might_sleep (__ipc_call, (uintptr_t) &call,
+                                    (uintptr_t) timeout);
+    }
+
+/**
+ * ipc_call - call an endpoint and wait for the reply
+ * @ep:       the endpoint
+ * @req:      the request
+ * @req_size: size of the request
+ * @rsp:      the buffer for the reply
+ * @rsp_size: size of the reply buffer
+ *
+ * return: size of the reply on success, negtive value on error
+ */
+
+int ipc_call (ipc_ep_id ep, const void * req, size_t req_size,
+              void * rsp, size_t rsp_size)
+    {
+    return ipc_timedcall (ep, req, req_size, rsp, rsp_size, UINT_MAX);
+    }
+
+static void __tick_q_callback_ipc_recv (task_id task)
+    {
+    task->ipc_recv = NULL;
+    }
+
+static int __ipc_receive (uintptr_t arg1, uintptr_t arg2)
+    {
+    struct ipc_recv * recv    = (struct ipc_recv *) arg1;
+    unsigned int      timeout = (unsigned int) arg2;
+    ipc_ep_id         ep      = recv->ep;
+    struct ipc_call * call;
+    task_id           client;
+
+    if (current == NULL)
+        {
+        return -1;
+        }
+
+    /* the clients with requests too long for this server are left pending */
+
+    if ((client = __ipc_client_find (ep, recv->size)) != NULL)
+        {
+        call = client->ipc_call;
+
+        __ipc_deliver (call, current, recv);
+
+        /* the client will wait for the reply forever */
+
+        task_fwait_q_move (&call->reply_q, client);
+
+        return (int) call->req_size;
+        }
+
+    if (timeout == 0)
+        {
+        return -1;
+        }
+
+    current->ipc_recv = recv;
+
+    task_fwait_q_add (&ep->servers, timeout, __tick_q_callback_ipc_recv);
+
+    return 0;
+    }
+
+/**
+ * ipc_timedreceive - receive a call from an endpoint with timeout
+ * @ep:      the endpoint
+ * @buff:    the buffer for the request
+ * @size:    size of the buffer
+ * @client:  the client received, used for ipc_reply
+ * @timeout: the max number of waiting ticks
+ *
+ * return: size of the request on success, negtive value on error or timeout
+ */
+
+int ipc_timedreceive (ipc_ep_id ep, void * buff, size_t size,
+                      ipc_client_id * client, unsigned int timeout)
+    {
+    struct ipc_recv recv;
+    int             ret;
+
+    if ((ep == NULL) || ((buff == NULL) && (size != 0)) || (client == NULL))
+        {
+        return -1;
+        }
+
+    recv.ep   = ep;
+    recv.buff = buff;
+    recv.size = size;
+    recv.call = NULL;
+
+    ret = do_critical_might_sleep (__ipc_receive, (uintptr_t) &recv,
+                                   (uintptr_t) timeout);
+
+    if (ret < 0)
+        {
+        return ret;
+        }
+
+    *client = recv.call;
+
+    return ret;
+    }
+
+/**
+ * ipc_receive - receive a call from an endpoint
+ * @ep:     the endpoint
+ * @buff:   the buffer for the request
+ * @size:   size of the buffer
+ * @client: the client received, used for ipc_reply
+ *
+ * return: size of the request on success, negtive value on error
+ */
+
+int ipc_receive (ipc_ep_id ep, void * buff, size_t size, ipc_client_id * client)
+    {
+    return ipc_timedreceive (ep, buff, size, client, UINT_MAX);
+    }
+
+static int __ipc_reply (uintptr_t arg1, uintptr_t arg2)
+    {
+    struct ipc_reply_ctx * ctx  = (struct ipc_reply_ctx *) arg1;
+    struct ipc_call      * call = ctx->call;
+    task_id                client;
+    dlist_t              * itr;
+    size_t                 size;
+
+    (void) arg2;
+
+    if (current == NULL)
+        {
+        return -1;
+        }
+
+    /*
+     * the call must be one served by current, it is looked up instead of just
+     * checking call->server, as the call of a deleted client is gone
+     */
+
+    dlist_foreach (itr, &current->ipc_served)
+        {
+        if (itr == &call->node)
+            {
+            break;
+            }
+        }
+
+    if (itr == &current->ipc_served)
+        {
+        return -1;
+        }
+
+    client = call->client;
+    size   = ctx->size < call->rsp_size ? ctx->size : call->rsp_size;
+
+    memcpy (call->rsp, ctx->buff, size);
+
+    dlist_del (&call->node);
+
+    call->server     = NULL;
+    client->ipc_call = NULL;
+
+    task_retval_set (client, (int) size);
+
+    /* give back the priority and tick slices */
+
+    task_prio_restore (current);
+
+    client->tick_slices  = current->tick_slices;
+    current->tick_slices = call->slices;
+
+    task_ready_q_ins (client);
+
+    return 0;
+    }
+
+/**
+ * ipc_reply - reply a call received, the reply is truncated if it is longer
+ *             than the reply buffer of the client
+ * @client: the client got from ipc_receive
+ * @buff:   the reply
+ * @size:   size of the reply
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int ipc_reply (ipc_client_id client, const void * buff, size_t size)
+    {
+    struct ipc_reply_ctx ctx;
+
+    if ((client == NULL) || ((buff == NULL) && (size != 0)))
+        {
+        return -1;
+        }
+
+    ctx.call = client;
+    ctx.buff = buff;
+    ctx.size = size;
+
+    return do_critical_non_irq (__ipc_reply, (uintptr_t) &ctx, 0);
+    }
+
+/**
+ * ipc_prio_inherit - pass the raised priority of a client to the server if the
+ *                    call is received, or just correct the location in the
+ *                    endpoint if not, must be invoked in critical
+ * @call: the call the client is making
+ * @prio: the new priority of the client
+ *
+ * return: NA
+ */
+
+void ipc_prio_inherit (struct ipc_call * call, uint8_t prio)
+    {
+    if (call->server != NULL)
+        {
+        task_prio_inherit (call->server, prio);
+        }
+    else
+        {
+        task_pwait_q_adj (&call->ep->callers, call->client);
+        }
+    }
+
+/**
+ * ipc_prio_restore - pass the lowered priority of a client to the server if the
+ *                    call is received, or just correct the location in the
+ *                    endpoint if not, must be invoked in critical
+ * @call: the call the client is making
+ *
+ * return: NA
+ */
+
+void ipc_prio_restore (struct ipc_call * call)
+    {
+    if (call->server != NULL)
+        {
+        task_prio_restore (call->server);
+        }
+    else
+        {
+        task_pwait_q_adj (&call->ep->callers, call->client);
+        }
+    }
+
+/**
+ * ipc_task_cleanup - clean up the ipc of a task being deleted, the calls
+ *                    received by the task and not replied are failed, and the
+ *                    call the task is making is taken back from the server,
+ *                    must be invoked in critical
+ * @task: the task being deleted
+ *
+ * return: NA
+ */
+
+void ipc_task_cleanup (task_id task)
+    {
+    struct ipc_call * call = task->ipc_call;
+    dlist_t         * itr;
+    dlist_t         * next;
+
+    task->ipc_recv = NULL;
+
+    /* the call is on the stack of the task, unlink it from the server */
+
+    if (call != NULL)
+        {
+        task->ipc_call = NULL;
+
+        if (call->server != NULL)
+            {
+            dlist_del (&call->node);
+
+            task_prio_restore (call->server);
+
+            call->server = NULL;
+            }
+        }
+
+    /* wake up the clients waiting for the reply of this server */
+
+    dlist_foreach_safe (itr, next, &task->ipc_served)
+        {
+        call = container_of (itr, struct ipc_call, node);
+
+        dlist_del (&call->node);
+
+        call->server           = NULL;
+        call->client->ipc_call = NULL;
+
+        task_retval_set (call->client, -1);
+        task_ready_q_add (call->client);
+        }
+    }
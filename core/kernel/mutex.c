@@ -17,6 +17,9 @@ modification history
 #include <wheel/common.h>
 
 #include <kernel/mutex.h>
+#include <kernel/rwlock.h>
+#include <kernel/ipc.h>
+#include <kernel/hrtimer.h>
 #include <kernel/critical.h>
 
 /**
@@ -35,12 +38,12 @@ int mutex_init (mutex_id mutex)
 
     mutex->owner   = NULL;
 
-    dlist_init (&mutex->pend_q);
+    pwait_q_init (&mutex->pend_q);
 
     return 0;
     }
 
-static inline void __try_raise_mutex_prio (mutex_id mutex, uint8_t prio)
+static void __try_raise_mutex_prio (mutex_id mutex, uint8_t prio)
     {
     if (mutex->prio <= prio)
         {
@@ -49,45 +52,68 @@ static inline void __try_raise_mutex_prio (mutex_id mutex, uint8_t prio)
 
     mutex->prio = prio;
 
-    /* owner's prio may be higher */
+    task_prio_inherit (mutex->owner, prio);
+    }
+
+/**
+ * task_prio_inherit - raise the priority of a lock holder for a task of <prio>
+ *                     pending on the lock, and pass it along if the holder is
+ *                     also pending on a lock, must be invoked in critical
+ * @task: the lock holder
+ * @prio: the priority inherited
+ *
+ * return: NA
+ */
 
-    if (prio >= mutex->owner->c_prio)
+void task_prio_inherit (task_id task, uint8_t prio)
+    {
+    /* holder's prio may be higher */
+
+    if (prio >= task->c_prio)
         {
         return;
         }
 
-    /* owner in ready_q and prio changed */
+    /* holder in ready_q and prio changed */
 
-    if (mutex->owner->status == TASK_STATUS_READY)
+    if (task->status == TASK_STATUS_READY)
         {
-        task_ready_q_del (mutex->owner);
-        }
+        task_ready_q_del (task);
+        task->c_prio = prio;
+        task_ready_q_add (task);
 
-    mutex->owner->c_prio = prio;
+        /* must not pend on lock, just return */
 
-    if (mutex->owner->status == TASK_STATUS_READY)
-        {
-        task_ready_q_add (mutex->owner);
-        /* must not pend on mutex, just return */
         return;
         }
 
-    if (mutex->owner->mutex_wanted != NULL)
+    task->c_prio = prio;
+
+    if (task->mutex_wanted != NULL)
+        {
+        task_pwait_q_adj (&task->mutex_wanted->pend_q, task);
+        __try_raise_mutex_prio (task->mutex_wanted, prio);
+        }
+    else if (task->rwlock_wanted != NULL)
+        {
+        task_pwait_q_adj (&task->rwlock_wanted->pend_q, task);
+        rwlock_prio_inherit (task->rwlock_wanted, prio);
+        }
+    else if (task->ipc_call != NULL)
         {
-        task_pwait_q_adj (&mutex->owner->mutex_wanted->pend_q, mutex->owner);
-        __try_raise_mutex_prio (mutex->owner->mutex_wanted, prio);
+        ipc_prio_inherit (task->ipc_call, prio);
         }
     }
 
 static void __recalc_mutex_prio (mutex_id mutex)
     {
-    if (dlist_empty (&mutex->pend_q))
+    if (pwait_q_empty (&mutex->pend_q))
         {
         mutex->prio = TASK_PRIO_MAX;
         }
     else
         {
-        mutex->prio = container_of (mutex->pend_q.next, task_t, pq_node)->c_prio;
+        mutex->prio = pwait_q_first (&mutex->pend_q)->c_prio;
         }
     }
 
@@ -104,8 +130,11 @@ static void __mutex_set_owner (mutex_id mutex, task_id owner)
 static inline bool __recalc_task_prio (task_id task)
     {
     mutex_id  mutex;
+    rwlock_id rwlock;
+    task_id   client;
     dlist_t * itr;
     uint8_t   prio = task->o_prio;
+    int       i;
 
     if (task->c_prio == prio)
         {
@@ -122,6 +151,28 @@ static inline bool __recalc_task_prio (task_id task)
             }
         }
 
+    for (i = 0; i < TASK_NR_RW_HOLDS; i++)
+        {
+        rwlock = task->rw_holds [i].rwlock;
+
+        if ((rwlock != NULL) && (rwlock->prio < prio))
+            {
+            prio = rwlock->prio;
+            }
+        }
+
+    /* the server of ipc calls keeps the priority of the clients */
+
+    dlist_foreach (itr, &task->ipc_served)
+        {
+        client = container_of (itr, struct ipc_call, node)->client;
+
+        if (client->c_prio < prio)
+            {
+            prio = client->c_prio;
+            }
+        }
+
     if (prio == task->c_prio)
         {
         return false;
@@ -157,15 +208,39 @@ static inline void __try_lower_mutex_prio (mutex_id mutex)
         return;
         }
 
-    if (!__recalc_task_prio (mutex->owner))
+    task_prio_restore (mutex->owner);
+    }
+
+/**
+ * task_prio_restore - recalculate the priority of a lock holder after the
+ *                     priority of one of the locks it holds lowered, and pass
+ *                     it along if the holder is also pending on a lock, must
+ *                     be invoked in critical
+ * @task: the lock holder
+ *
+ * return: NA
+ */
+
+void task_prio_restore (task_id task)
+    {
+    if (!__recalc_task_prio (task))
         {
         return;
         }
 
-    if (mutex->owner->mutex_wanted)
+    if (task->mutex_wanted != NULL)
+        {
+        task_pwait_q_adj (&task->mutex_wanted->pend_q, task);
+        __try_lower_mutex_prio (task->mutex_wanted);
+        }
+    else if (task->rwlock_wanted != NULL)
+        {
+        task_pwait_q_adj (&task->rwlock_wanted->pend_q, task);
+        rwlock_prio_restore (task->rwlock_wanted);
+        }
+    else if (task->ipc_call != NULL)
         {
-        task_pwait_q_adj (&mutex->owner->mutex_wanted->pend_q, mutex->owner);
-        __try_lower_mutex_prio (mutex->owner->mutex_wanted);
+        ipc_prio_restore (task->ipc_call);
         }
     }
 
@@ -264,6 +339,74 @@ int mutex_timedlock (mutex_id mutex, unsigned int timeout)
                                     (uintptr_t) timeout);
     }
 
+/**
+ * mutex_hrtimedlock - lock a mutex with timeout in microseconds
+ * @mutex: the mutex to be locked
+ * @us:    the max number of waiting microseconds
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int mutex_hrtimedlock (mutex_id mutex, uint32_t us)
+    {
+    return hrtimer_wait (__mutex_lock, (uintptr_t) mutex, us,
+                         __tick_q_callback_mutex);
+    }
+
+/**
+ * mutex_lock_for - lock a mutex for a pending task, the task is given the mutex
+ *                  and waked up if the mutex is free, otherwise it is moved to
+ *                  the pend queue of the mutex, must be invoked in critical
+ * @mutex: the mutex to be locked
+ * @task:  the pending task
+ *
+ * return: NA
+ */
+
+void mutex_lock_for (mutex_id mutex, task_id task)
+    {
+    if (mutex->recurse == 0)
+        {
+        task_ready_q_add (task);
+
+        __mutex_set_owner (mutex, task);
+
+        return;
+        }
+
+    task->mutex_wanted = mutex;
+
+    task_pwait_q_move (&mutex->pend_q, task);
+
+    __try_raise_mutex_prio (mutex, task->c_prio);
+    }
+
+/**
+ * mutex_relock_for - lock a mutex for a task just waked up by timeout, the task
+ *                    is given the mutex if it is free, otherwise it is pended
+ *                    again on the mutex, must be invoked in critical
+ * @mutex: the mutex to be locked
+ * @task:  the task waked up
+ *
+ * return: NA
+ */
+
+void mutex_relock_for (mutex_id mutex, task_id task)
+    {
+    if (mutex->recurse == 0)
+        {
+        __mutex_set_owner (mutex, task);
+
+        return;
+        }
+
+    task->mutex_wanted = mutex;
+
+    task_pwait_q_pend (&mutex->pend_q, task);
+
+    __try_raise_mutex_prio (mutex, task->c_prio);
+    }
+
 int __mutex_unlock (uintptr_t arg1, uintptr_t arg2)
     {
     mutex_id mutex = (mutex_id) arg1;
@@ -290,16 +433,16 @@ int __mutex_unlock (uintptr_t arg1, uintptr_t arg2)
 
     dlist_del (&mutex->node);
 
-    (void) __recalc_task_prio (current);
+    task_prio_restore (current);
 
-    if (dlist_empty (&mutex->pend_q))
+    next_task = pwait_q_first (&mutex->pend_q);
+
+    if (next_task == NULL)
         {
         mutex->owner = NULL;
         return 0;
         }
 
-    next_task = container_of (mutex->pend_q.next, task_t, pq_node);
-
     next_task->mutex_wanted = NULL;
 
     /* next_task->c_prio needless change */
@@ -0,0 +1,242 @@
+/* pool.c - fixed-size memory block pool library */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+a pool is a buffer split into blocks of the same size, the free blocks are
+linked in a singly linked list by their first word, so allocating and freeing
+are O(1), no searching, no splitting, no merging and no chunk header.
+
+the semaphore of the pool counts the free blocks, so a task can pend on it when
+the pool is empty. the list itself is protected by int_lock, it is only a few
+instructions. blocks can be freed from isr, but can only be allocated in task
+context, as the semaphore can only be taken in task context.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <wheel/common.h>
+#include <wheel/irq.h>
+
+#include <kernel/pool.h>
+#include <kernel/sem.h>
+
+/**
+ * pool_init - initialize a pool on a given buffer
+ * @pool:     the pool to be initialized
+ * @buff:     the buffer for the blocks, aligned to POOL_ALIGN
+ * @blk_size: size of each block
+ * @nr_blks:  number of blocks, the buffer must hold POOL_BLK_SIZE (blk_size)
+ *            * nr_blks bytes
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int pool_init (pool_id pool, void * buff, size_t blk_size, size_t nr_blks)
+    {
+    if ((pool == NULL) || (buff == NULL) || (blk_size == 0) || (nr_blks == 0))
+        {
+        return -1;
+        }
+
+    if (((uintptr_t) buff) & (POOL_ALIGN - 1))
+        {
+        return -1;
+        }
+
+    blk_size = POOL_BLK_SIZE (blk_size);
+
+    if (nr_blks > ((size_t) -1 - (uintptr_t) buff) / blk_size)
+        {
+        return -1;
+        }
+
+    sem_init (&pool->sem, nr_blks);
+
+    pool->free     = NULL;
+    pool->fresh    = (char *) buff;
+    pool->start    = (char *) buff;
+    pool->end      = (char *) buff + blk_size * nr_blks;
+    pool->blk_size = blk_size;
+    pool->nr_blks  = nr_blks;
+    pool->flags    = 0;
+
+    return 0;
+    }
+
+/**
+ * pool_create - create a pool with the buffer allocated from the heap
+ * @blk_size: size of each block
+ * @nr_blks:  number of blocks
+ *
+ * return: the pool id on success, NULL on error
+ */
+
+pool_id pool_create (size_t blk_size, size_t nr_blks)
+    {
+    size_t  hdr_size = round_up (sizeof (pool_t), POOL_ALIGN);
+    pool_id pool;
+
+    if ((blk_size == 0) || (nr_blks == 0))
+        {
+        return NULL;
+        }
+
+    if (nr_blks > ((size_t) -1 - hdr_size) / POOL_BLK_SIZE (blk_size))
+        {
+        return NULL;
+        }
+
+    pool = (pool_id) malloc (hdr_size + POOL_BLK_SIZE (blk_size) * nr_blks);
+
+    if (pool == NULL)
+        {
+        return NULL;
+        }
+
+    (void) pool_init (pool, ((char *) pool) + hdr_size, blk_size, nr_blks);
+
+    pool->flags = POOL_FLAG_MALLOC;
+
+    return pool;
+    }
+
+/**
+ * pool_delete - delete a pool created by pool_create, all the blocks must have
+ *               been freed
+ * @pool: the pool to be deleted
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int pool_delete (pool_id pool)
+    {
+    if ((pool == NULL) || !(pool->flags & POOL_FLAG_MALLOC))
+        {
+        return -1;
+        }
+
+    if (pool->sem.count != pool->nr_blks)
+        {
+        return -1;
+        }
+
+    free (pool);
+
+    return 0;
+    }
+
+/**
+ * __pool_get - take a block from a pool, the semaphore must have been taken
+ * @pool: the pool
+ *
+ * return: the block
+ */
+
+static void * __pool_get (pool_id pool)
+    {
+    unsigned long flags = int_lock ();
+    void        * blk   = pool->free;
+
+    if (blk != NULL)
+        {
+        pool->free = *(void **) blk;
+        }
+    else
+        {
+        blk          = pool->fresh;
+        pool->fresh += pool->blk_size;
+        }
+
+    int_unlock (flags);
+
+    return blk;
+    }
+
+/**
+ * pool_alloc - allocate a block from a pool without waiting
+ * @pool: the pool
+ *
+ * return: the block on success, NULL on error or the pool is empty
+ */
+
+void * pool_alloc (pool_id pool)
+    {
+    if (pool == NULL)
+        {
+        return NULL;
+        }
+
+    if (sem_trywait (&pool->sem) != 0)
+        {
+        return NULL;
+        }
+
+    return __pool_get (pool);
+    }
+
+/**
+ * pool_timedalloc - allocate a block from a pool, wait if the pool is empty
+ * @pool:    the pool
+ * @timeout: the max number of waiting ticks
+ *
+ * return: the block on success, NULL on error or timeout
+ */
+
+void * pool_timedalloc (pool_id pool, unsigned int timeout)
+    {
+    if (pool == NULL)
+        {
+        return NULL;
+        }
+
+    if (sem_timedwait (&pool->sem, timeout) != 0)
+        {
+        return NULL;
+        }
+
+    return __pool_get (pool);
+    }
+
+/**
+ * pool_free - free a block to a pool, can be invoked in isr
+ * @pool: the pool
+ * @blk:  the block got from the pool
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int pool_free (pool_id pool, void * blk)
+    {
+    unsigned long flags;
+
+    if ((pool == NULL) || !pool_owns (pool, blk))
+        {
+        return -1;
+        }
+
+    if ((((char *) blk) - pool->start) % pool->blk_size)
+        {
+        return -1;
+        }
+
+    flags = int_lock ();
+
+    *(void **) blk = pool->free;
+    pool->free     = blk;
+
+    int_unlock (flags);
+
+    return sem_post (&pool->sem);
+    }
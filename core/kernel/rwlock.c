@@ -0,0 +1,477 @@
+/* rwlock.c - reader-writer lock library */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+a rwlock can be held by one writer or many readers. every holder takes one of
+the <rw_holds> slots in its tcb, the slot is linked in the <holders> list of the
+rwlock, so the priority of the highest waiter (<prio>) can be inherited by all
+the holders, the readers and the writer alike, just like a mutex owner.
+
+waiters of both modes are queued in one priority wait queue, when the rwlock is
+released, the highest priority waiter is granted, if it is a reader, all the
+other readers in front of the first waiting writer (all of the waiting readers
+for RWLOCK_PREFER_READER) are granted too.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <limits.h>
+#include <stdbool.h>
+
+#include <wheel/common.h>
+
+#include <kernel/rwlock.h>
+#include <kernel/mutex.h>
+#include <kernel/critical.h>
+
+/**
+ * rwlock_init - initialize a rwlock
+ * @rwlock: the rwlock to be initialized
+ * @option: RWLOCK_PREFER_WRITER or RWLOCK_PREFER_READER
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int rwlock_init (rwlock_id rwlock, uint8_t option)
+    {
+    if ((rwlock == NULL) || (option > RWLOCK_PREFER_READER))
+        {
+        return -1;
+        }
+
+    rwlock->readers     = 0;
+    rwlock->prio        = TASK_PRIO_MAX;
+    rwlock->option      = option;
+    rwlock->nr_wwaiters = 0;
+    rwlock->writer      = NULL;
+
+    dlist_init (&rwlock->holders);
+    pwait_q_init (&rwlock->pend_q);
+
+    return 0;
+    }
+
+/**
+ * __rw_hold_find - find the hold slot of a task for a rwlock
+ * @task:   the task
+ * @rwlock: the rwlock, NULL to find a free slot
+ *
+ * return: the slot found or NULL if not found
+ */
+
+static struct rw_hold * __rw_hold_find (task_id task, rwlock_id rwlock)
+    {
+    int i;
+
+    for (i = 0; i < TASK_NR_RW_HOLDS; i++)
+        {
+        if (task->rw_holds [i].rwlock == rwlock)
+            {
+            return &task->rw_holds [i];
+            }
+        }
+
+    return NULL;
+    }
+
+static void __recalc_rwlock_prio (rwlock_id rwlock)
+    {
+    if (pwait_q_empty (&rwlock->pend_q))
+        {
+        rwlock->prio = TASK_PRIO_MAX;
+        }
+    else
+        {
+        rwlock->prio = pwait_q_first (&rwlock->pend_q)->c_prio;
+        }
+    }
+
+/**
+ * rwlock_prio_inherit - raise the priority of a rwlock and all its holders for
+ *                       a task of <prio> pending on it, must be invoked in
+ *                       critical
+ * @rwlock: the rwlock
+ * @prio:   the priority of the pending task
+ *
+ * return: NA
+ */
+
+void rwlock_prio_inherit (rwlock_id rwlock, uint8_t prio)
+    {
+    dlist_t * itr;
+
+    if (rwlock->prio <= prio)
+        {
+        return;
+        }
+
+    rwlock->prio = prio;
+
+    dlist_foreach (itr, &rwlock->holders)
+        {
+        task_prio_inherit (container_of (itr, struct rw_hold, node)->task, prio);
+        }
+    }
+
+/**
+ * rwlock_prio_restore - recalculate the priority of a rwlock when its waiters
+ *                       changed, and restore the priorities of the holders if
+ *                       lowered, must be invoked in critical
+ * @rwlock: the rwlock
+ *
+ * return: NA
+ */
+
+void rwlock_prio_restore (rwlock_id rwlock)
+    {
+    uint8_t   prio = rwlock->prio;
+    dlist_t * itr;
+
+    __recalc_rwlock_prio (rwlock);
+
+    if (prio == rwlock->prio)
+        {
+        return;
+        }
+
+    dlist_foreach (itr, &rwlock->holders)
+        {
+        task_prio_restore (container_of (itr, struct rw_hold, node)->task);
+        }
+    }
+
+static inline bool __rwlock_can_take (rwlock_id rwlock, uint8_t mode)
+    {
+    if (rwlock->writer != NULL)
+        {
+        return false;
+        }
+
+    if (mode == RWLOCK_MODE_WRITE)
+        {
+        return rwlock->readers == 0;
+        }
+
+    return (rwlock->option == RWLOCK_PREFER_READER) || (rwlock->nr_wwaiters == 0);
+    }
+
+static void __rwlock_take (rwlock_id rwlock, task_id task, uint8_t mode)
+    {
+    struct rw_hold * hold = __rw_hold_find (task, NULL);
+
+    /* a free slot is always there, checked before taking or pending */
+
+    hold->rwlock  = rwlock;
+    hold->task    = task;
+    hold->recurse = 1;
+
+    dlist_add_tail (&rwlock->holders, &hold->node);
+
+    if (mode == RWLOCK_MODE_WRITE)
+        {
+        rwlock->writer = task;
+        }
+    else
+        {
+        rwlock->readers++;
+        }
+    }
+
+static void __rwlock_grant_waiter (rwlock_id rwlock, task_id task)
+    {
+    task->rwlock_wanted = NULL;
+
+    if (task->rwlock_mode == RWLOCK_MODE_WRITE)
+        {
+        rwlock->nr_wwaiters--;
+        }
+
+    __rwlock_take (rwlock, task, task->rwlock_mode);
+
+    task_ready_q_add (task);
+    }
+
+/**
+ * __rwlock_grant - grant the rwlock to the waiters if possible
+ * @rwlock: the rwlock
+ *
+ * return: NA
+ */
+
+static void __rwlock_grant (rwlock_id rwlock)
+    {
+    task_id   task = pwait_q_first (&rwlock->pend_q);
+    dlist_t * itr;
+    dlist_t * next;
+
+    if ((task == NULL) || (rwlock->writer != NULL))
+        {
+        return;
+        }
+
+    if (task->rwlock_mode == RWLOCK_MODE_WRITE)
+        {
+        if (rwlock->readers != 0)
+            {
+            return;
+            }
+
+        __rwlock_grant_waiter (rwlock, task);
+        }
+    else
+        {
+        dlist_foreach_safe (itr, next, &rwlock->pend_q.tasks)
+            {
+            task = container_of (itr, task_t, pq_node);
+
+            if (task->rwlock_mode == RWLOCK_MODE_READ)
+                {
+                __rwlock_grant_waiter (rwlock, task);
+                }
+            else if (rwlock->option == RWLOCK_PREFER_WRITER)
+                {
+                break;
+                }
+            }
+        }
+
+    rwlock_prio_restore (rwlock);
+
+    /* the new holders may be lower than the waiters left */
+
+    dlist_foreach (itr, &rwlock->holders)
+        {
+        task_prio_inherit (container_of (itr, struct rw_hold, node)->task,
+                           rwlock->prio);
+        }
+    }
+
+static void __tick_q_callback_rwlock (task_id task)
+    {
+    rwlock_id rwlock = task->rwlock_wanted;
+
+    task->rwlock_wanted = NULL;
+
+    if (task->rwlock_mode == RWLOCK_MODE_WRITE)
+        {
+        rwlock->nr_wwaiters--;
+
+        /* the readers blocked by this writer may go now */
+
+        __rwlock_grant (rwlock);
+        }
+
+    rwlock_prio_restore (rwlock);
+    }
+
+static int __rwlock_lock (rwlock_id rwlock, uint8_t mode, unsigned int timeout)
+    {
+    struct rw_hold * hold;
+
+    if (current == NULL)
+        {
+        return 0;       /* pre-kernel, no racing */
+        }
+
+    hold = __rw_hold_find (current, rwlock);
+
+    if (hold != NULL)
+        {
+
+        /* upgrade a read hold will dead lock */
+
+        if ((rwlock->writer != current) && (mode == RWLOCK_MODE_WRITE))
+            {
+            return -1;
+            }
+
+        hold->recurse++;
+
+        return 0;
+        }
+
+    if (__rw_hold_find (current, NULL) == NULL)
+        {
+        return -1;      /* too many rwlocks held */
+        }
+
+    if (__rwlock_can_take (rwlock, mode))
+        {
+        __rwlock_take (rwlock, current, mode);
+
+        return 0;
+        }
+
+    if (timeout == 0)
+        {
+        return -1;
+        }
+
+    current->rwlock_wanted = rwlock;
+    current->rwlock_mode   = mode;
+
+    if (mode == RWLOCK_MODE_WRITE)
+        {
+        rwlock->nr_wwaiters++;
+        }
+
+    rwlock_prio_inherit (rwlock, current->c_prio);
+
+    task_pwait_q_add (&rwlock->pend_q, timeout, __tick_q_callback_rwlock);
+
+    return 0;
+    }
+
+static int __rwlock_rdlock (uintptr_t arg1, uintptr_t arg2)
+    {
+    return __rwlock_lock ((rwlock_id) arg1, RWLOCK_MODE_READ, (unsigned int) arg2);
+    }
+
+static int __rwlock_wrlock (uintptr_t arg1, uintptr_t arg2)
+    {
+    return __rwlock_lock ((rwlock_id) arg1, RWLOCK_MODE_WRITE, (unsigned int) arg2);
+    }
+
+/**
+ * rwlock_rdlock - lock a rwlock for read
+ * @rwlock: the rwlock to be locked
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int rwlock_rdlock (rwlock_id rwlock)
+    {
+    return do_critical_might_sleep (__rwlock_rdlock, (uintptr_t) rwlock, UINT_MAX);
+    }
+
+/**
+ * rwlock_tryrdlock - try to lock a rwlock for read
+ * @rwlock: the rwlock to be locked
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int rwlock_tryrdlock (rwlock_id rwlock)
+    {
+    return do_critical_non_irq (__rwlock_rdlock, (uintptr_t) rwlock, 0);
+    }
+
+/**
+ * rwlock_timedrdlock - lock a rwlock for read with timeout
+ * @rwlock:  the rwlock to be locked
+ * @timeout: the max number of waiting ticks
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int rwlock_timedrdlock (rwlock_id rwlock, unsigned int timeout)
+    {
+    return do_critical_might_sleep (__rwlock_rdlock, (uintptr_t) rwlock,
+                                    (uintptr_t) timeout);
+    }
+
+/**
+ * rwlock_wrlock - lock a rwlock for write
+ * @rwlock: the rwlock to be locked
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int rwlock_wrlock (rwlock_id rwlock)
+    {
+    return do_critical_might_sleep (__rwlock_wrlock, (uintptr_t) rwlock, UINT_MAX);
+    }
+
+/**
+ * rwlock_trywrlock - try to lock a rwlock for write
+ * @rwlock: the rwlock to be locked
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int rwlock_trywrlock (rwlock_id rwlock)
+    {
+    return do_critical_non_irq (__rwlock_wrlock, (uintptr_t) rwlock, 0);
+    }
+
+/**
+ * rwlock_timedwrlock - lock a rwlock for write with timeout
+ * @rwlock:  the rwlock to be locked
+ * @timeout: the max number of waiting ticks
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int rwlock_timedwrlock (rwlock_id rwlock, unsigned int timeout)
+    {
+    return do_critical_might_sleep (__rwlock_wrlock, (uintptr_t) rwlock,
+                                    (uintptr_t) timeout);
+    }
+
+static int __rwlock_unlock (uintptr_t arg1, uintptr_t arg2)
+    {
+    rwlock_id        rwlock = (rwlock_id) arg1;
+    struct rw_hold * hold;
+
+    (void) arg2;
+
+    if (current == NULL)
+        {
+        return 0;       /* pre-kernel, no racing */
+        }
+
+    hold = __rw_hold_find (current, rwlock);
+
+    if (hold == NULL)
+        {
+        return -1;
+        }
+
+    if (--hold->recurse != 0)
+        {
+        return 0;
+        }
+
+    dlist_del (&hold->node);
+
+    hold->rwlock = NULL;
+
+    if (rwlock->writer == current)
+        {
+        rwlock->writer = NULL;
+        }
+    else
+        {
+        rwlock->readers--;
+        }
+
+    task_prio_restore (current);
+
+    if (rwlock->readers == 0)
+        {
+        __rwlock_grant (rwlock);
+        }
+
+    return 0;
+    }
+
+/**
+ * rwlock_unlock - unlock a rwlock held for read or write
+ * @rwlock: the rwlock to be unlocked
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int rwlock_unlock (rwlock_id rwlock)
+    {
+    return do_critical_non_irq (__rwlock_unlock, (uintptr_t) rwlock, 0);
+    }
@@ -0,0 +1,239 @@
+/* rwlock_bench.c - rwlock read-heavy throughput benchmark */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+some reader tasks of the same priority keep scanning a shared table, a writer
+task of higher priority updates the table every few ticks. the readers are
+round-robin scheduled, so a reader may be switched out while holding the lock.
+with mutex the other readers have to pend, with rwlock they can go on.
+
+the "rwbench" command is only built with RTW_CONFIG_RWLOCK_BENCH defined (in
+hw_config.h).
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <wheel/common.h>
+#include <wheel/config.h>
+#include <wheel/cmder.h>
+
+#include <kernel/task.h>
+#include <kernel/sem.h>
+#include <kernel/mutex.h>
+#include <kernel/rwlock.h>
+
+#ifdef RTW_CONFIG_RWLOCK_BENCH
+
+#undef putchar
+
+/* defines */
+
+#define RWBENCH_MAX_READERS     8
+#define RWBENCH_TABLE_SIZE      64
+#define RWBENCH_STACK_SIZE      0x180
+#define RWBENCH_WRITE_INTERVAL  2       /* in ticks */
+
+#define RWBENCH_READER_PRIO     (TASK_PRIO_MAX - 1)
+#define RWBENCH_WRITER_PRIO     (TASK_PRIO_MAX - 2)
+
+/* locals */
+
+static uint32_t          bench_table [RWBENCH_TABLE_SIZE];
+static volatile uint32_t bench_sum;
+static volatile bool     bench_stop;
+static volatile uint32_t bench_reads [RWBENCH_MAX_READERS];
+static volatile uint32_t bench_writes;
+static bool              bench_use_rwlock;
+static mutex_t           bench_mutex;
+static rwlock_t          bench_rwlock;
+static sem_t             bench_done;
+
+static inline void __bench_lock (bool write)
+    {
+    if (!bench_use_rwlock)
+        {
+        (void) mutex_lock (&bench_mutex);
+        }
+    else if (write)
+        {
+        (void) rwlock_wrlock (&bench_rwlock);
+        }
+    else
+        {
+        (void) rwlock_rdlock (&bench_rwlock);
+        }
+    }
+
+static inline void __bench_unlock (void)
+    {
+    if (bench_use_rwlock)
+        {
+        (void) rwlock_unlock (&bench_rwlock);
+        }
+    else
+        {
+        (void) mutex_unlock (&bench_mutex);
+        }
+    }
+
+static int __bench_reader (uintptr_t idx)
+    {
+    uint32_t sum;
+    int      i;
+
+    while (!bench_stop)
+        {
+        __bench_lock (false);
+
+        for (i = 0, sum = 0; i < RWBENCH_TABLE_SIZE; i++)
+            {
+            sum += bench_table [i];
+            }
+
+        __bench_unlock ();
+
+        bench_sum = sum;
+        bench_reads [idx]++;
+        }
+
+    return sem_post (&bench_done);
+    }
+
+static int __bench_writer (uintptr_t arg)
+    {
+    int i;
+
+    (void) arg;
+
+    while (!bench_stop)
+        {
+        (void) task_delay (RWBENCH_WRITE_INTERVAL);
+
+        __bench_lock (true);
+
+        for (i = 0; i < RWBENCH_TABLE_SIZE; i++)
+            {
+            bench_table [i]++;
+            }
+
+        __bench_unlock ();
+
+        bench_writes++;
+        }
+
+    return sem_post (&bench_done);
+    }
+
+static uint32_t __bench_run (bool use_rwlock, unsigned int readers,
+                             unsigned int ticks)
+    {
+    unsigned int i;
+    unsigned int spawned = 0;
+    uint32_t     reads   = 0;
+
+    bench_use_rwlock = use_rwlock;
+    bench_stop       = false;
+    bench_writes     = 0;
+
+    for (i = 0; i < readers; i++)
+        {
+        bench_reads [i] = 0;
+
+        if (task_spawn ("rwb_r", RWBENCH_READER_PRIO, 0, RWBENCH_STACK_SIZE,
+                        __bench_reader, (uintptr_t) i) != NULL)
+            {
+            spawned++;
+            }
+        }
+
+    if (task_spawn ("rwb_w", RWBENCH_WRITER_PRIO, 0, RWBENCH_STACK_SIZE,
+                    __bench_writer, 0) != NULL)
+        {
+        spawned++;
+        }
+
+    (void) task_delay (ticks);
+
+    bench_stop = true;
+
+    while (spawned--)
+        {
+        (void) sem_wait (&bench_done);
+        }
+
+    for (i = 0; i < readers; i++)
+        {
+        reads += bench_reads [i];
+        }
+
+    return reads;
+    }
+
+static void __bench_show (cmder_t * cmder, const char * name, uint32_t reads,
+                          unsigned int ticks)
+    {
+    char buff [64];
+
+    sprintf (buff, "%-7s %10u reads %6u writes %8u reads/tick\n", name,
+             (unsigned int) reads, (unsigned int) bench_writes,
+             (unsigned int) (reads / ticks));
+    cmder->putstr (cmder->arg, buff);
+    }
+
+/**
+ * rwbench - compare the read-heavy throughput of rwlock and mutex
+ *
+ * usage: rwbench [readers] [ticks]
+ */
+
+static int rwbench (cmder_t * cmder, int argc, char * argv [])
+    {
+    unsigned int readers = 4;
+    unsigned int ticks   = RTW_SYS_TICK_HZ * 2;
+    uint32_t     reads;
+
+    if (argc > 1)
+        {
+        readers = (unsigned int) strtoul (argv [1], NULL, 0);
+        }
+
+    if (argc > 2)
+        {
+        ticks = (unsigned int) strtoul (argv [2], NULL, 0);
+        }
+
+    if ((readers == 0) || (readers > RWBENCH_MAX_READERS) || (ticks == 0))
+        {
+        cmder->putstr (cmder->arg, "usage: rwbench [readers (1-8)] [ticks]\n");
+        return -1;
+        }
+
+    (void) mutex_init (&bench_mutex);
+    (void) rwlock_init (&bench_rwlock, RWLOCK_PREFER_WRITER);
+    (void) sem_init (&bench_done, 0);
+
+    reads = __bench_run (false, readers, ticks);
+    __bench_show (cmder, "mutex", reads, ticks);
+
+    reads = __bench_run (true, readers, ticks);
+    __bench_show (cmder, "rwlock", reads, ticks);
+
+    return 0;
+    }
+
+RTW_CMDER_CMD_DEF ("rwbench", "compare read throughput of rwlock and mutex",
+                   rwbench);
+
+#endif  /* RTW_CONFIG_RWLOCK_BENCH */
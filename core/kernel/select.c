@@ -0,0 +1,266 @@
+/* select.c - kernel object multiple waiting library */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+a task has only one <pq_node>, so it can be in only one pend queue. to wait on
+more than one object, the selecting task is pended in a private queue on its
+own stack, and one <kobj_sel_t> for each object is linked to the <sel_q> of the
+object. when an object becomes ready, the routine changing the object state
+invokes <kobj_sel_notify> in critical, and the selecting task is waked up.
+
+kobj_select only report the readiness, just like poll, the ready objects should
+then be taken by non-blocking routines like sem_trywait, mq_timedrecv with 0
+timeout or event_recv with 0 timeout. the only exception is timer, the
+expirations are consumed when a timer is reported ready.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#include <wheel/common.h>
+#include <wheel/list.h>
+
+#include <kernel/select.h>
+#include <kernel/critical.h>
+
+/* typedefs */
+
+struct kobj_select_ctx
+    {
+    kobj_sel_t   * sels;
+    unsigned int   nr;
+    unsigned int   timeout;
+    bool           pended;
+    dlist_t        pend_q;      /* private pend queue for the selecting task */
+    };
+
+/**
+ * __sel_q - get the select queue of the object in a select entry
+ * @sel: the select entry
+ *
+ * return: the select queue or NULL if the type is invalid
+ */
+
+static inline dlist_t * __sel_q (kobj_sel_t * sel)
+    {
+    switch (sel->type)
+        {
+        case KOBJ_SEL_SEM:
+            return &((sem_t *) sel->obj)->sel_q;
+        case KOBJ_SEL_EVENT:
+            return &((event_t *) sel->obj)->sel_q;
+        case KOBJ_SEL_TIMER:
+            return &((timer_t *) sel->obj)->sel_q;
+        default:
+            return NULL;
+        }
+    }
+
+/**
+ * __sel_ready - check if the object in a select entry is ready
+ * @sel: the select entry
+ *
+ * return: true if ready, false if not
+ */
+
+static inline bool __sel_ready (kobj_sel_t * sel)
+    {
+    uint32_t set;
+
+    switch (sel->type)
+        {
+        case KOBJ_SEL_SEM:
+            return ((sem_t *) sel->obj)->count != 0;
+        case KOBJ_SEL_EVENT:
+            set = ((event_t *) sel->obj)->event_set & sel->wanted;
+
+            if (sel->option == EVENT_WAIT_ALL)
+                {
+                return set == sel->wanted;
+                }
+
+            return set != 0;
+        case KOBJ_SEL_TIMER:
+            return ((timer_t *) sel->obj)->expired != 0;
+        default:
+            return false;
+        }
+    }
+
+/**
+ * __sel_scan - update the ready flags of all entries in a select context
+ * @ctx: the select context
+ *
+ * return: the number of ready entries
+ */
+
+static unsigned int __sel_scan (struct kobj_select_ctx * ctx)
+    {
+    unsigned int i;
+    unsigned int nr_ready = 0;
+
+    for (i = 0; i < ctx->nr; i++)
+        {
+        kobj_sel_t * sel = &ctx->sels [i];
+
+        sel->ready = __sel_ready (sel);
+
+        if (!sel->ready)
+            {
+            continue;
+            }
+
+        nr_ready++;
+
+        /* expirations of timers are consumed once reported */
+
+        if (sel->type == KOBJ_SEL_TIMER)
+            {
+            ((timer_t *) sel->obj)->expired = 0;
+            }
+        }
+
+    return nr_ready;
+    }
+
+static int __kobj_select_wait (uintptr_t arg1, uintptr_t arg2)
+    {
+    struct kobj_select_ctx * ctx = (struct kobj_select_ctx *) arg1;
+    unsigned int             nr_ready;
+    unsigned int             i;
+
+    (void) arg2;
+
+    nr_ready = __sel_scan (ctx);
+
+    if ((nr_ready != 0) || (ctx->timeout == 0))
+        {
+        return (int) nr_ready;
+        }
+
+    for (i = 0; i < ctx->nr; i++)
+        {
+        kobj_sel_t * sel = &ctx->sels [i];
+
+        sel->task = current;
+
+        dlist_add_tail (__sel_q (sel), &sel->node);
+        }
+
+    dlist_init (&ctx->pend_q);
+
+    task_fwait_q_add (&ctx->pend_q, ctx->timeout, NULL);
+
+    ctx->pended = true;
+
+    return 0;
+    }
+
+static int __kobj_select_done (uintptr_t arg1, uintptr_t arg2)
+    {
+    struct kobj_select_ctx * ctx = (struct kobj_select_ctx *) arg1;
+    unsigned int             i;
+
+    (void) arg2;
+
+    for (i = 0; i < ctx->nr; i++)
+        {
+        dlist_del (&ctx->sels [i].node);
+        }
+
+    return (int) __sel_scan (ctx);
+    }
+
+/**
+ * kobj_select - wait until one or more kernel objects become ready
+ * @sels:    the select entries, setup by kobj_sel_xxx
+ * @nr:      number of select entries
+ * @timeout: the max number of waiting ticks
+ *
+ * return: number of ready objects (the <ready> field of the ready entries will
+ *         be set), 0 on timeout, negtive value on error
+ */
+
+int kobj_select (kobj_sel_t * sels, unsigned int nr, unsigned int timeout)
+    {
+    struct kobj_select_ctx ctx;
+    unsigned int           i;
+    int                    ret;
+
+    if ((sels == NULL) || (nr == 0))
+        {
+        return -1;
+        }
+
+    for (i = 0; i < nr; i++)
+        {
+        if ((sels [i].obj == NULL) || (__sel_q (&sels [i]) == NULL))
+            {
+            return -1;
+            }
+        }
+
+    ctx.sels    = sels;
+    ctx.nr      = nr;
+    ctx.timeout = timeout;
+    ctx.pended  = false;
+
+    if (timeout == 0)
+        {
+        return do_critical_non_irq (__kobj_select_wait, (uintptr_t) &ctx, 0);
+        }
+
+    ret = do_critical_might_sleep (__kobj_select_wait, (uintptr_t) &ctx, 0);
+
+    if (!ctx.pended)
+        {
+        return ret;
+        }
+
+    /* waked up by an object or timeout, unlink the entries and collect */
+
+    return do_critical_non_irq (__kobj_select_done, (uintptr_t) &ctx, 0);
+    }
+
+/**
+ * kobj_sel_notify - wake up the tasks selecting an object if it is ready now,
+ *                   must be invoked in critical
+ * @sel_q: the select queue of the object
+ *
+ * return: NA
+ */
+
+void kobj_sel_notify (dlist_t * sel_q)
+    {
+    dlist_t * itr;
+
+    dlist_foreach (itr, sel_q)
+        {
+        kobj_sel_t * sel = container_of (itr, kobj_sel_t, node);
+
+        /* already waked up by another object or timeout */
+
+        if (!(sel->task->status & TASK_STATUS_PEND))
+            {
+            continue;
+            }
+
+        if (!__sel_ready (sel))
+            {
+            continue;
+            }
+
+        task_ready_q_add (sel->task);
+        }
+    }
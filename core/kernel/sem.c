@@ -19,6 +19,8 @@ modification history
 #include <kernel/sem.h>
 #include <kernel/task.h>
 #include <kernel/critical.h>
+#include <kernel/select.h>
+#include <kernel/hrtimer.h>
 
 /**
  * sem_init - initialize a semahpore
@@ -38,6 +40,7 @@ int sem_init (sem_t * sem, uintptr_t value)
     sem->count = value;
 
     dlist_init (&sem->pend_q);
+    dlist_init (&sem->sel_q);
 
     return 0;
     }
@@ -101,6 +104,19 @@ int sem_timedwait (sem_t * sem, unsigned int timeout)
                                     (uintptr_t) timeout);
     }
 
+/**
+ * sem_hrtimedwait - lock a semaphore with timeout in microseconds
+ * @sem: the semaphore to be locked
+ * @us:  the max number of waiting microseconds
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int sem_hrtimedwait (sem_t * sem, uint32_t us)
+    {
+    return hrtimer_wait (__sem_wait, (uintptr_t) sem, us, NULL);
+    }
+
 int __sem_post (uintptr_t arg1, uintptr_t arg2)
     {
     sem_t       * sem = (sem_t *) arg1;
@@ -116,6 +132,8 @@ int __sem_post (uintptr_t arg1, uintptr_t arg2)
     if (dlist_empty (&sem->pend_q))
         {
         sem->count++;
+
+        kobj_sel_notify (&sem->sel_q);
         }
     else
         {
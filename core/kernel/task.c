@@ -22,11 +22,15 @@ modification history
 #include <wheel/mem.h>
 #include <wheel/defer.h>
 #include <wheel/cmder.h>
+#include <wheel/sysclk.h>
 
 #include <arch/sync.h>
 
 #include <kernel/task.h>
 #include <kernel/critical.h>
+#include <kernel/rwlock.h>
+#include <kernel/ipc.h>
+#include <kernel/tick.h>
 
 #undef putchar
 
@@ -166,6 +170,7 @@ task_id task_create (const char * name, uint8_t prio, uint32_t options,
     task->o_prio = prio;
 
     dlist_init (&task->mutex_owned);
+    dlist_init (&task->ipc_served);
 
     task_ctx_init (task);
 
@@ -188,9 +193,18 @@ static int __task_delete (uintptr_t arg1, uintptr_t arg2)
     dlist_t        * itr, * next;
     deferred_job_t * job;
     task_id          task = (task_id) arg1;
+    int              i;
 
     (void) arg2;
 
+    /*
+     * fail the calls the task served and take back the call it is making, do
+     * it before a pending task is resumed (and leave the wait queue), so no
+     * server can reply to it in between
+     */
+
+    ipc_task_cleanup (task);
+
     if (task != current)
         {
         task_pc_set (task, (uintptr_t) task_delete);
@@ -217,6 +231,17 @@ static int __task_delete (uintptr_t arg1, uintptr_t arg2)
         mutex_unlock (mutex);
         }
 
+    /* release all the rwlocks held by current */
+
+    for (i = 0; i < TASK_NR_RW_HOLDS; i++)
+        {
+        if (task->rw_holds [i].rwlock != NULL)
+            {
+            task->rw_holds [i].recurse = 1;
+            rwlock_unlock (task->rw_holds [i].rwlock);
+            }
+        }
+
     /* create deferred job struct at the end of the stack (stack base) */
 
     job = (deferred_job_t *) task->stack_base;
@@ -253,7 +278,7 @@ int task_delete (task_id task)
  * __task_resume - resume a task in critical region
  */
 
-static int __task_resume (uintptr_t arg1, uintptr_t arg2)
+int __task_resume (uintptr_t arg1, uintptr_t arg2)
     {
     task_id task = (task_id) arg1;
 
@@ -388,6 +413,31 @@ uint8_t task_prio_get (task_id task)
     return task->c_prio;
     }
 
+/**
+ * task_slack_set - set the slack of the timed waits of a task, the task may be
+ *                  waked up at most <slack> ticks later than the timeout, so
+ *                  its timeout can be merged with others in one tick, the
+ *                  default is 0 (no slack), task_delay_until never use slack
+ * @task:  the given task if NULL current will be selected
+ * @slack: the slack in ticks
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int task_slack_set (task_id task, unsigned int slack)
+    {
+    task = task == NULL ? current : task;
+
+    if (task == NULL)
+        {
+        return -1;
+        }
+
+    task->tick_slack = slack;
+
+    return 0;
+    }
+
 static int __task_prio_set (uintptr_t arg1, uintptr_t arg2)
     {
     task_id   task = (task_id) arg1;
@@ -494,7 +544,8 @@ int __task_delay (uintptr_t arg1, uintptr_t arg2)
 
     current->status |= TASK_STATUS_DELAY;
 
-    tick_q_add (&current->tq_node, ticks, __tick_q_callback_task, 0);
+    tick_q_add (&current->tq_node, ticks, current->tick_slack,
+                __tick_q_callback_task, 0);
 
     return 0;
     }
@@ -511,6 +562,95 @@ int task_delay (unsigned int ticks)
     return do_critical_might_sleep (__task_delay, (uintptr_t) ticks, 0);
     }
 
+static int __task_delay_until (uintptr_t arg1, uintptr_t arg2)
+    {
+    uint64_t deadline = *(uint64_t *) arg1;
+    uint64_t now      = tick_count_get ();
+
+    (void) arg2;
+
+    if (deadline <= now)
+        {
+        return 1;               /* overrun, not delayed */
+        }
+
+    task_ready_q_del (current);
+
+    current->status |= TASK_STATUS_DELAY;
+
+    tick_q_add (&current->tq_node, (unsigned int) (deadline - now), 0,
+                __tick_q_callback_task, 0);
+
+    return 0;
+    }
+
+/**
+ * task_delay_until - delay a task until an absolute tick, for periodic tasks
+ *                    without drift, the release jitter (the time between the
+ *                    deadline and the task running again) and the overruns are
+ *                    recorded in the task
+ * @last_wake: the tick released last time, initialized with tick_count_get ()
+ *             before the loop, updated to the new deadline
+ * @period:    the period in ticks
+ *
+ *     uint64_t last = tick_count_get ();
+ *
+ *     while (1)
+ *         {
+ *         (void) task_delay_until (&last, 1);
+ *         do_something ();
+ *         }
+ *
+ * the missed releases are not skipped, if the task overruns the deadline, it
+ * runs again at once to catch up.
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int task_delay_until (uint64_t * last_wake, unsigned int period)
+    {
+    uint64_t deadline;
+    uint64_t cycles;
+    uint64_t late;
+    int      ret;
+
+    if ((last_wake == NULL) || (period == 0) || (current == NULL))
+        {
+        return -1;
+        }
+
+    deadline = *last_wake + period;
+
+    ret = do_critical_might_sleep (__task_delay_until, (uintptr_t) &deadline, 0);
+
+    if (ret < 0)
+        {
+        return ret;
+        }
+
+    *last_wake = deadline;
+
+    current->releases++;
+
+    if (ret > 0)
+        {
+        current->overruns++;
+        }
+
+    cycles = sysclk_ticks_to_cycles (deadline);
+    late   = sysclk_cycles ();
+    late   = late > cycles ? late - cycles : 0;
+
+    current->jitter_last = late > UINT32_MAX ? UINT32_MAX : (uint32_t) late;
+
+    if (current->jitter_last > current->jitter_max)
+        {
+        current->jitter_max = current->jitter_last;
+        }
+
+    return 0;
+    }
+
 /**
  * task_lock - disable the task preemptive
  *
@@ -579,18 +719,96 @@ void task_ready_q_init (void)
         }
     }
 
+/**
+ * pwait_q_init - initialize a priority wait queue
+ * @q: the priority wait queue
+ *
+ * return: NA
+ */
+
+void pwait_q_init (pwait_q_t * q)
+    {
+    q->bmap = 0;
+
+    dlist_init (&q->tasks);
+    }
+
+static void __pwait_q_add (pwait_q_t * q, task_id task)
+    {
+    uint8_t   prio = task->c_prio;
+    uint32_t  higher;
+    dlist_t * prev;
+
+    if (q->bmap & (1 << (31 - prio)))
+        {
+        prev = q->tails [prio];
+        }
+    else
+        {
+        /* only keep the bits of the priorities higher than <prio> */
+
+        higher = prio == 0 ? 0 : (q->bmap >> (32 - prio)) << (32 - prio);
+
+        /*
+         * the new task should follow the last task of the nearest higher
+         * priority, the lowest set bit in <higher>, or be the first one
+         */
+
+        prev = higher == 0 ? &q->tasks : q->tails [__clz (higher & -higher)];
+
+        q->bmap |= 1 << (31 - prio);
+        }
+
+    dlist_add (prev, &task->pq_node);
+
+    q->tails [prio] = &task->pq_node;
+
+    task->pwait_q   = q;
+    task->pq_prio   = prio;
+    }
+
+static void __pwait_q_del (pwait_q_t * q, task_id task)
+    {
+    uint8_t   prio = task->pq_prio;
+    dlist_t * prev = task->pq_node.prev;
+
+    if (q->tails [prio] == &task->pq_node)
+        {
+        if ((prev != &q->tasks) &&
+            (container_of (prev, task_t, pq_node)->pq_prio == prio))
+            {
+            q->tails [prio] = prev;
+            }
+        else
+            {
+            q->bmap &= ~(1 << (31 - prio));
+            }
+        }
+
+    dlist_del (&task->pq_node);
+
+    task->pwait_q = NULL;
+    }
+
 void __ready_q_put (struct task * task, bool head)
     {
     uint8_t prio = task->c_prio;
 
     if (task->status & TASK_STATUS_PEND)
         {
-        dlist_del (&task->pq_node);
+        if (task->pwait_q != NULL)
+            {
+            __pwait_q_del (task->pwait_q, task);
+            }
+        else
+            {
+            dlist_del (&task->pq_node);
+            }
         }
 
     if (task->status & TASK_STATUS_DELAY)
         {
-        dlist_del (&task->tq_node.node);
+        tick_q_del (&task->tq_node);
         }
 
     task->status &= ~(TASK_STATUS_PEND | TASK_STATUS_DELAY);
@@ -689,8 +907,8 @@ static inline void __task_q_xwait_timed (dlist_t * q, unsigned int timeout,
     if (timeout != UINT_MAX)
         {
         current->status |= TASK_STATUS_DELAY;
-        tick_q_add (&current->tq_node, timeout, __tick_q_callback_task,
-                    (uintptr_t) callback);
+        tick_q_add (&current->tq_node, timeout, current->tick_slack,
+                    __tick_q_callback_task, (uintptr_t) callback);
         }
     }
 
@@ -711,31 +929,8 @@ void task_fwait_q_add (dlist_t * q, unsigned int timeout,
     __task_q_xwait_timed (q, timeout, callback);
     }
 
-static void __pwait_q_add (dlist_t * q, task_id task)
-    {
-    dlist_t * itr;
-
-    dlist_foreach (itr, q)
-        {
-        if (task->c_prio < container_of (itr, task_t, pq_node)->c_prio)
-            {
-            break;
-            }
-        }
-
-    /*
-     * 1) if q is empty, itr will just be itr
-     * 2) if all tasks in have higher priority than current, itr will be q
-     * 3) otherwise, itr will be the first node that priority lower than current
-     *
-     * for all of these three conditions, just add current in front of q
-     */
-
-    dlist_add_tail (itr, &task->pq_node);
-    }
-
 /**
- * task_fwait_q_add - add current task to a priority wait queue
+ * task_pwait_q_add - add current task to a priority wait queue
  * @q:        the priority wait queue
  * @timeout:  the max ticks the task wait in the queue
  * @callback: the timeout call back
@@ -743,12 +938,12 @@ static void __pwait_q_add (dlist_t * q, task_id task)
  * return: NA
  */
 
-void task_pwait_q_add (dlist_t * q, unsigned int timeout,
+void task_pwait_q_add (pwait_q_t * q, unsigned int timeout,
                        void (* callback) (task_id task))
     {
     __pwait_q_add (q, current);
 
-    __task_q_xwait_timed (q, timeout, callback);
+    __task_q_xwait_timed (&q->tasks, timeout, callback);
     }
 
 /**
@@ -760,12 +955,81 @@ void task_pwait_q_add (dlist_t * q, unsigned int timeout,
  * return: NA
  */
 
-void task_pwait_q_adj (dlist_t * q, task_id task)
+void task_pwait_q_adj (pwait_q_t * q, task_id task)
     {
-    dlist_del (&task->pq_node);
+    __pwait_q_del (q, task);
     __pwait_q_add (q, task);
     }
 
+static void __wait_q_leave (task_id task)
+    {
+    if (task->pwait_q != NULL)
+        {
+        __pwait_q_del (task->pwait_q, task);
+        }
+    else
+        {
+        dlist_del (&task->pq_node);
+        }
+
+    if (task->status & TASK_STATUS_DELAY)
+        {
+        tick_q_del (&task->tq_node);
+        task->status &= ~TASK_STATUS_DELAY;
+        }
+    }
+
+/**
+ * task_pwait_q_move - move a pending task to another priority wait queue, the
+ *                     timeout of the task is cancelled, it will wait forever
+ * @q:    the new priority wait queue
+ * @task: the pending task to move
+ *
+ * return: NA
+ */
+
+void task_pwait_q_move (pwait_q_t * q, task_id task)
+    {
+    __wait_q_leave (task);
+    __pwait_q_add (q, task);
+    }
+
+/**
+ * task_pwait_q_pend - pend a task waked up (by timeout) again in a priority
+ *                     wait queue, it will wait forever
+ * @q:    the priority wait queue
+ * @task: the task to pend
+ *
+ * return: NA
+ */
+
+void task_pwait_q_pend (pwait_q_t * q, task_id task)
+    {
+    if (task->status == TASK_STATUS_READY)
+        {
+        task_ready_q_del (task);
+        }
+
+    task->status |= TASK_STATUS_PEND;
+
+    __pwait_q_add (q, task);
+    }
+
+/**
+ * task_fwait_q_move - move a pending task to another fifo wait queue, the
+ *                     timeout of the task is cancelled, it will wait forever
+ * @q:    the new fifo wait queue
+ * @task: the pending task to move
+ *
+ * return: NA
+ */
+
+void task_fwait_q_move (dlist_t * q, task_id task)
+    {
+    __wait_q_leave (task);
+    dlist_add_tail (q, &task->pq_node);
+    }
+
 static void __task_show (cmder_t * cmder, task_id task)
     {
     char buff [12];
@@ -840,3 +1104,38 @@ static int task_show (cmder_t * cmder, int argc, char * argv [])
 
 RTW_CMDER_CMD_DEF ("i", "show task info", task_show);
 
+static int task_jitter_show (cmder_t * cmder, int argc, char * argv [])
+    {
+    dlist_t * itr;
+    task_id   task;
+    char      buff [48];
+
+    cmder->putstr (cmder->arg,
+                   "\nNAME      RELEASES   OVERRUNS  LAST(us)   MAX(us)\n");
+
+    cmder->putstr (cmder->arg,
+                   "======= ========== ========== ========= =========\n");
+
+    dlist_foreach (itr, &all_tasks)
+        {
+        task = container_of (itr, task_t, node);
+
+        if (task->releases == 0)
+            {
+            continue;
+            }
+
+        cmder_print (cmder, task->name, MAX_TASK_NAME_LEN - 1, CMDER_PRINT_LALIGN);
+
+        sprintf (buff, " %10u %10u %9u %9u\n", (unsigned int) task->releases,
+                 (unsigned int) task->overruns,
+                 (unsigned int) sysclk_cycles_to_us (task->jitter_last),
+                 (unsigned int) sysclk_cycles_to_us (task->jitter_max));
+        cmder->putstr (cmder->arg, buff);
+        }
+
+    return 0;
+    }
+
+RTW_CMDER_CMD_DEF ("jitter", "show release jitter of periodic tasks",
+                   task_jitter_show);
@@ -10,23 +10,49 @@ modification history
 01a,18aug18,cfm  writen
 */
 
+#include <stdio.h>
+
 #include <wheel/common.h>
 #include <wheel/list.h>
+#include <wheel/seqlock.h>
+#include <wheel/cmder.h>
 
 #include <kernel/critical.h>
 #include <kernel/task.h>
 #include <kernel/tick.h>
 
-volatile uint64_t tick_count;
+#undef putchar
+
+/*
+ * tick_count is only changed in __tick_shot_n (serialized by critical), it is
+ * published to the two copies in tick_counts, so 64-bit tick count can be read
+ * in any context without tearing or locking
+ */
+
+static uint64_t   tick_count;
+static uint64_t   tick_counts [2];
+static seqlatch_t tick_latch = SEQLATCH_INIT;
 
 static unsigned int rr_slices = 5;          // TODO: correct value configiralbe
 
+/*
+ * number of expiries merged into others by the slack, the periodic tick fires
+ * anyway, so merging saves only the separate tick queue processing, interrupts
+ * and wakeups drop only when the tick goes tickless, that is, the tick source
+ * is programmed for the next expiry and advances the queue by tick_shot_n (n)
+ */
+
+static uint32_t     tick_q_merged = 0;
+
 dlist_t tick_q = DLIST_INIT (tick_q);
 
 /**
  * tick_q_add - add a tick queue node to tick queue
  * @node:  the tick queue to be added, usually come from a timer or task
- * @ticks: the max number of ticks the node stay in the tick queue
+ * @ticks: the min number of ticks the node stay in the tick queue
+ * @slack: the extra ticks the node may stay, if some node expires in the window
+ *         of [ticks, ticks + slack], this node is merged to it and they are
+ *         processed in one tick
  * @pfn:   the timeout callback
  * @arg:   the argument for the timeout callback
  *
@@ -34,26 +60,49 @@ dlist_t tick_q = DLIST_INIT (tick_q);
  */
 
 void tick_q_add (struct tick_q_node * node, unsigned int ticks,
+                 unsigned int slack,
                  void (*pfn) (struct tick_q_node *, uintptr_t), uintptr_t arg)
     {
-    dlist_t * itr;
-    dlist_t * ins = NULL;
+    dlist_t            * itr;
+    dlist_t            * ins = NULL;
+    struct tick_q_node * n;
 
-    if (!dlist_empty (&tick_q))
+    dlist_foreach (itr, &tick_q)
         {
-        dlist_foreach (itr, &tick_q)
+        n = container_of (itr, struct tick_q_node, node);
+
+        if (ticks > n->ticks_left)
             {
-            struct tick_q_node * n = container_of (itr, struct tick_q_node, node);
+            ticks -= n->ticks_left;
+            continue;
+            }
 
-            if (ticks <= n->ticks_left)
+        if (n->ticks_left - ticks > slack)
+            {
+            n->ticks_left -= ticks;
+            ins = itr;
+            break;
+            }
+
+        /* n expires in the slack window, append to the nodes expire with it */
+
+        if (n->ticks_left != ticks)
+            {
+            tick_q_merged++;
+            }
+
+        ticks = 0;
+
+        for (itr = itr->next; itr != &tick_q; itr = itr->next)
+            {
+            if (container_of (itr, struct tick_q_node, node)->ticks_left != 0)
                 {
-                n->ticks_left -= ticks;
                 ins = itr;
                 break;
                 }
-
-            ticks -= n->ticks_left;
             }
+
+        break;
         }
 
     node->ticks_left = ticks;
@@ -135,6 +184,8 @@ static int __tick_shot_n (uintptr_t arg1, uintptr_t arg2)
 
     tick_count += ticks;
 
+    SEQLATCH_PUBLISH (&tick_latch, tick_counts, tick_count);
+
     tick_q_shot (ticks);
 
     /*
@@ -176,3 +227,47 @@ void tick_shot (void)
     tick_shot_n (1);
     }
 
+
+/**
+ * tick_count_get - get the number of ticks passed since the system started,
+ *                  can be invoked in any context
+ *
+ * return: the tick count
+ */
+
+uint64_t tick_count_get (void)
+    {
+    uint64_t ticks;
+
+    SEQLATCH_FETCH (&tick_latch, tick_counts, ticks);
+
+    return ticks;
+    }
+
+/**
+ * tick_merged_get - get the number of tick queue expiries merged into others in
+ *                   the slack windows
+ *
+ * return: the number of expiries merged
+ */
+
+uint32_t tick_merged_get (void)
+    {
+    return tick_q_merged;
+    }
+
+static int tick_show (cmder_t * cmder, int argc, char * argv [])
+    {
+    char buff [48];
+
+    sprintf (buff, "ticks:           %u\n", (unsigned int) tick_count_get ());
+    cmder->putstr (cmder->arg, buff);
+
+    sprintf (buff, "expiries merged: %u\n", (unsigned int) tick_q_merged);
+    cmder->putstr (cmder->arg, buff);
+
+    return 0;
+    }
+
+RTW_CMDER_CMD_DEF ("tick", "show tick count and expiries merged by slack",
+                   tick_show);
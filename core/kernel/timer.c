@@ -15,17 +15,73 @@ modification history
 #include <stdlib.h>
 
 #include <wheel/common.h>
+#include <wheel/config.h>
 
 #include <kernel/timer.h>
 #include <kernel/task.h>
 #include <kernel/tick.h>
 #include <kernel/critical.h>
+#include <kernel/select.h>
+#include <kernel/sem.h>
+#include <kernel/pool.h>
+
+/* defines */
+
+#ifndef RTW_TIMER_POOL_BLKS
+#define RTW_TIMER_POOL_BLKS     0
+#endif
+
+/* locals */
+
+#if RTW_TIMER_POOL_BLKS > 0
+
+/* timer_create takes timers from this pool first, then the heap */
+
+POOL_DEF (timer_pool, sizeof (timer_t), RTW_TIMER_POOL_BLKS);
+
+#endif
+
+/*
+with RTW_CONFIG_TIMER_TASK, the tick path only queues the expired timers, the
+callbacks are run by the timer service task in batches, so the time spent in
+the tick is short and not affected by slow callbacks. an expiration is never
+lost, if a timer expires again before its callback is run, the callback is
+just run one more time.
+*/
+
+#ifdef RTW_CONFIG_TIMER_TASK
+
+/* defines */
+
+#ifndef RTW_TIMER_TASK_PRIO
+#define RTW_TIMER_TASK_PRIO     1
+#endif
+
+#define TIMER_TASK_BATCH        8
+
+/* typedefs */
+
+struct timer_svc_job
+    {
+    void      (* pfn) (uintptr_t);
+    uintptr_t    arg;
+    unsigned int times;
+    };
+
+/* locals */
+
+static dlist_t timer_svc_q   = DLIST_INIT (timer_svc_q);
+static sem_t   timer_svc_sem = SEM_INIT (timer_svc_sem, 0);
+
+#endif
 
 /**
  * timer_init - initialize a timer
  * @timer:    the timer to be initialized
  * @flag:     timer options
  * @interval: timer interval
+ * @slack:    ticks the expiry may be delayed to merge with others, the
+ *            deadlines of a repeated timer do not drift with the slack
  * @pfn:      timeout callback
  * @arg:      the argument for the timeout callback
  *
@@ -33,7 +89,7 @@ modification history
  */
 
 int timer_init (timer_id timer, uint16_t flag, unsigned long interval,
-                void (*pfn) (uintptr_t), uintptr_t arg)
+                unsigned int slack, void (*pfn) (uintptr_t), uintptr_t arg)
     {
     if ((flag > TIMER_FLAG_REPEATED) || (interval == 0) || (pfn == NULL))
         {
@@ -43,16 +99,48 @@ int timer_init (timer_id timer, uint16_t flag, unsigned long interval,
     timer->status   = TIMER_STAT_INACTIVE;
     timer->flag     = flag;
     timer->interval = interval;
+    timer->slack    = slack;
     timer->pfn      = pfn;
     timer->arg      = arg;
+    timer->expired  = 0;
+    timer->deadline = 0;
+    timer->overruns = 0;
+
+    timer->svc_pending = 0;
+
+    dlist_init (&timer->sel_q);
+    dlist_init (&timer->svc_node);
 
     return 0;
     }
 
+/**
+ * __timer_free - free a timer got in timer_create
+ * @timer: the timer
+ *
+ * return: NA
+ */
+
+static void __timer_free (timer_id timer)
+    {
+#if RTW_TIMER_POOL_BLKS > 0
+    if (pool_owns (&timer_pool, timer))
+        {
+        (void) pool_free (&timer_pool, timer);
+
+        return;
+        }
+#endif
+
+    free (timer);
+    }
+
 /**
  * timer_create - create a timer
  * @flag:     timer options
  * @interval: timer interval
+ * @slack:    ticks the expiry may be delayed to merge with others, the
+ *            deadlines of a repeated timer do not drift with the slack
  * @pfn:      timeout callback
  * @arg:      the argument for the timeout callback
  *
@@ -60,19 +148,29 @@ int timer_init (timer_id timer, uint16_t flag, unsigned long interval,
  */
 
 timer_id timer_create (uint16_t flag, unsigned long interval,
-                       void (*pfn) (uintptr_t), uintptr_t arg)
+                       unsigned int slack, void (*pfn) (uintptr_t),
+                       uintptr_t arg)
     {
-    timer_id timer = (timer_id) malloc (sizeof (timer_t));
+    timer_id timer = NULL;
+
+#if RTW_TIMER_POOL_BLKS > 0
+    timer = (timer_id) pool_alloc (&timer_pool);
+#endif
+
+    if (timer == NULL)
+        {
+        timer = (timer_id) malloc (sizeof (timer_t));
+        }
 
     if (timer == NULL)
         {
         return NULL;
         }
 
-    if (timer_init (timer, flag, interval, pfn, arg))
+    if (timer_init (timer, flag, interval, slack, pfn, arg))
         {
-        free (timer);
-        timer = NULL;
+        __timer_free (timer);
+        return NULL;
         }
 
     timer->flag |= TIMER_FLAG_MALLOC;
@@ -83,9 +181,22 @@ timer_id timer_create (uint16_t flag, unsigned long interval,
 static void __tick_q_callback_timer (struct tick_q_node * node, uintptr_t arg)
     {
     timer_id timer = container_of (node, timer_t, tq_node);
+    uint64_t now;
 
     (void) arg;
 
+#ifdef RTW_CONFIG_TIMER_TASK
+    if (timer->svc_pending++ == 0)
+        {
+        if (dlist_empty (&timer_svc_q))
+            {
+            (void) sem_post (&timer_svc_sem);
+            }
+
+        dlist_add_tail (&timer_svc_q, &timer->svc_node);
+        }
+#else
+
     /* prevent task switch in user timer callback */
 
     task_lock_cnt++;
@@ -93,14 +204,36 @@ static void __tick_q_callback_timer (struct tick_q_node * node, uintptr_t arg)
     timer->pfn (timer->arg);
 
     task_lock_cnt--;
+#endif
+
+    timer->expired++;
+
+    kobj_sel_notify (&timer->sel_q);
 
-    if (timer->flag != TIMER_FLAG_REPEATED)
+    if (!(timer->flag & TIMER_FLAG_REPEATED))
         {
         timer->status = TIMER_STAT_INACTIVE;
         return;
         }
 
-    tick_q_add (&timer->tq_node, timer->interval, __tick_q_callback_timer, 0);
+    /*
+     * anchor the next expiry to the absolute deadline instead of now, so the
+     * period does not drift when several ticks are shot at once, the periods
+     * already passed are skipped and counted as overruns
+     */
+
+    now = tick_count_get ();
+
+    timer->deadline += timer->interval;
+
+    while (timer->deadline <= now)
+        {
+        timer->deadline += timer->interval;
+        timer->overruns++;
+        }
+
+    tick_q_add (&timer->tq_node, (unsigned int) (timer->deadline - now),
+                timer->slack, __tick_q_callback_timer, 0);
     }
 
 int __timer_start (uintptr_t arg1, uintptr_t arg2)
@@ -114,7 +247,10 @@ int __timer_start (uintptr_t arg1, uintptr_t arg2)
         tick_q_del (&timer->tq_node);
         }
 
-    tick_q_add (&timer->tq_node, timer->interval, __tick_q_callback_timer, 0);
+    timer->deadline = tick_count_get () + timer->interval;
+
+    tick_q_add (&timer->tq_node, timer->interval, timer->slack,
+                __tick_q_callback_timer, 0);
 
     timer->status = TIMER_STAT_ACTIVE;
 
@@ -144,6 +280,15 @@ int __timer_stop (uintptr_t arg1, uintptr_t arg2)
 
     (void) arg2;
 
+    /* drop the callbacks not run yet by the timer task */
+
+    if (timer->svc_pending != 0)
+        {
+        dlist_del (&timer->svc_node);
+
+        timer->svc_pending = 0;
+        }
+
     if (timer->status != TIMER_STAT_ACTIVE)
         {
         return 0;
@@ -206,9 +351,74 @@ int timer_delete (timer_id timer)
 
     if (timer->flag & TIMER_FLAG_MALLOC)
         {
-        free (timer);
+        __timer_free (timer);
         }
 
     return 0;
     }
 
+#ifdef RTW_CONFIG_TIMER_TASK
+
+/**
+ * __timer_svc_fetch - fetch a batch of expired timers for the timer task
+ * @arg1: the job array to be filled, TIMER_TASK_BATCH entries
+ * @arg2: not used
+ *
+ * return: number of jobs fetched
+ */
+
+static int __timer_svc_fetch (uintptr_t arg1, uintptr_t arg2)
+    {
+    struct timer_svc_job * jobs = (struct timer_svc_job *) arg1;
+    timer_id               timer;
+    int                    nr   = 0;
+
+    (void) arg2;
+
+    while (!dlist_empty (&timer_svc_q) && (nr < TIMER_TASK_BATCH))
+        {
+        timer = container_of (timer_svc_q.next, timer_t, svc_node);
+
+        dlist_del (&timer->svc_node);
+
+        /* copy the callback, the timer may be deleted once out of the queue */
+
+        jobs [nr].pfn   = timer->pfn;
+        jobs [nr].arg   = timer->arg;
+        jobs [nr].times = timer->svc_pending;
+
+        timer->svc_pending = 0;
+
+        nr++;
+        }
+
+    return nr;
+    }
+
+static void timer_task (void)
+    {
+    struct timer_svc_job jobs [TIMER_TASK_BATCH];
+    int                  nr;
+    int                  i;
+
+    while (1)
+        {
+        (void) sem_wait (&timer_svc_sem);
+
+        while ((nr = do_critical_non_irq (__timer_svc_fetch, (uintptr_t) jobs,
+                                          0)) > 0)
+            {
+            for (i = 0; i < nr; i++)
+                {
+                while (jobs [i].times--)
+                    {
+                    jobs [i].pfn (jobs [i].arg);
+                    }
+                }
+            }
+        }
+    }
+
+RTW_TASK_DEF (tmrsvc, RTW_TIMER_TASK_PRIO, 0, 0x200, timer_task, 0);
+
+#endif
@@ -0,0 +1,157 @@
+/* arena.c - pointer bump arena allocator */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+an arena hands out memory by bumping a pointer, there is no chunk header, no
+free and no searching, all the memory is given back at once by arena_reset, or
+back to a mark by arena_release. it is for the objects living forever (like the
+ones created at boot, or in the builds no free is allowed), or the temporary
+objects all freed together.
+
+the bumping is done with interrupts locked for a few instructions, so an arena
+can be used in any context.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <wheel/common.h>
+#include <wheel/arena.h>
+#include <wheel/heap.h>
+#include <wheel/irq.h>
+
+/**
+ * arena_init - initialize an arena on a given buffer
+ * @arena: the arena to be initialized
+ * @buff:  the buffer
+ * @size:  size of the buffer
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int arena_init (arena_t * arena, char * buff, size_t size)
+    {
+    if ((arena == NULL) || (buff == NULL) || (buff + size < buff))
+        {
+        return -1;
+        }
+
+    arena->base = buff;
+    arena->cur  = buff;
+    arena->end  = buff + size;
+
+    return 0;
+    }
+
+/**
+ * arena_alloc_align - allocate a block of memory from an arena with alignment
+ * @arena: the arena to allocate from
+ * @align: the expected alignment value, power of 2
+ * @bytes: size of memory in bytes to allocate
+ *
+ * return: the allocated memory block or NULL if fail
+ */
+
+char * arena_alloc_align (arena_t * arena, size_t align, size_t bytes)
+    {
+    unsigned long flags;
+    char        * mem;
+
+    if ((arena == NULL) || (align & (align - 1)))
+        {
+        return NULL;
+        }
+
+    align = align < ALLOC_ALIGN ? ALLOC_ALIGN : align;
+    bytes = round_up (bytes == 0 ? 1 : bytes, ALLOC_ALIGN);
+
+    flags = int_lock ();
+
+    mem = (char *) round_up (arena->cur, align);
+
+    if ((mem < arena->cur) || (mem > arena->end) ||
+        ((size_t) (arena->end - mem) < bytes))
+        {
+        mem = NULL;
+        }
+    else
+        {
+        arena->cur = mem + bytes;
+        }
+
+    int_unlock (flags);
+
+    return mem;
+    }
+
+/**
+ * arena_alloc - allocate a block of memory from an arena
+ * @arena: the arena to allocate from
+ * @bytes: size of memory in bytes to allocate
+ *
+ * return: the allocated memory block or NULL if fail
+ */
+
+char * arena_alloc (arena_t * arena, size_t bytes)
+    {
+    return arena_alloc_align (arena, ALLOC_ALIGN, bytes);
+    }
+
+/**
+ * arena_reset - free all the memory allocated from an arena
+ * @arena: the arena
+ *
+ * return: NA
+ */
+
+void arena_reset (arena_t * arena)
+    {
+    arena->cur = arena->base;
+    }
+
+/**
+ * arena_mark - get a mark of the current allocating position of an arena
+ * @arena: the arena
+ *
+ * return: the mark, to be used in arena_release
+ */
+
+char * arena_mark (arena_t * arena)
+    {
+    return arena->cur;
+    }
+
+/**
+ * arena_release - free all the memory allocated from an arena after a mark
+ * @arena: the arena
+ * @mark:  the mark got from arena_mark
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int arena_release (arena_t * arena, char * mark)
+    {
+    unsigned long flags;
+    int           ret = -1;
+
+    flags = int_lock ();
+
+    if ((mark >= arena->base) && (mark <= arena->cur))
+        {
+        arena->cur = mark;
+        ret        = 0;
+        }
+
+    int_unlock (flags);
+
+    return ret;
+    }
@@ -11,55 +11,59 @@ modification history
 */
 
 #include <string.h>
+#include <stdbool.h>
 
 #include <wheel/heap.h>
+#include <wheel/irq.h>
 
-#include <kernel/mutex.h>
-
-/**
- * __heap_compare_nk - compare size_node with a key
- */
-
-static int __heap_compare_nk (bi_node_t * n, uintptr_t k)
-    {
-    size_node_t * sn = container_of (n, size_node_t, node.bin);
-
-    if ((uintptr_t) sn->size == k)
-        {
-        return 0;
-        }
+#ifdef HEAP_TRACE
+#include <wheel/sysclk.h>
+#endif
 
-    return (uintptr_t) sn->size > k ? 1 : -1;
-    }
+#include <kernel/mutex.h>
+#include <kernel/task.h>
 
-/**
- * __heap_compare_nn - compare two size_nodes
- */
+/* the sizes rbtree, keyed by the chunk size, see __rb_put_chunk */
 
-static int __heap_compare_nn (bi_node_t * a, bi_node_t * b)
-    {
-    return __heap_compare_nk (a, (uintptr_t) container_of (b, size_node_t, node.bin)->size);
-    }
+CRB_GENERATE (__sizes, size_node_t, node, size_t, size, CRB_CMP_NUM, NULL)
 
 /**
- * heap_init - initialize a heap struct
+ * heap_init_type - initialize a heap struct with the way to index free chunks
  * @heap: the given heap
+ * @type: HEAP_TYPE_RBTREE (best fit) or HEAP_TYPE_TLSF (good fit, O(1))
  *
  * return: 0 on success, negtive value on error
  */
 
-int heap_init (heap_t * heap)
+int heap_init_type (heap_t * heap, uint8_t type)
     {
-    if (heap == NULL)
+    if ((heap == NULL) || (type > HEAP_TYPE_TLSF))
         {
         return -1;
         }
 
-#ifdef HEAP_DEBUG
-    memset (heap->sn_guard, 0x5c, sizeof (struct size_node) * 2);
-#endif
+    heap->type     = type;
+    heap->deferred = NULL;
+
+    memset (heap->isr_caches, 0, sizeof (heap->isr_caches));
+
+    if (type == HEAP_TYPE_TLSF)
+        {
+        heap->tlsf = NULL;          /* carved from the first block added */
+        }
+    else
+        {
+        int i;
+
+        heap->small_map = 0;
+
+        for (i = 0; i < HEAP_NR_SMALLS; i++)
+            {
+            dlist_init (&heap->smalls [i]);
+            }
 
-    rb_init (&heap->sizes, __heap_compare_nn, __heap_compare_nk);
+        crb_init (&heap->sizes);
+        }
 
     dlist_init (&heap->blocks);
 
@@ -68,6 +72,18 @@ int heap_init (heap_t * heap)
     return 0;
     }
 
+/**
+ * heap_init - initialize a heap struct, the free chunks are indexed in rbtree
+ * @heap: the given heap
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int heap_init (heap_t * heap)
+    {
+    return heap_init_type (heap, HEAP_TYPE_RBTREE);
+    }
+
 /**
  * __is_free - check if a chunk is free
  * @chunk: the given chunk
@@ -126,30 +142,39 @@ static inline char * __get_mem_block (chunk_t * chunk)
 
 static inline size_node_t * __get_size_node (heap_t * heap, chunk_t * chunk)
     {
-    if (chunk->size >= (sizeof (size_node_t) + sizeof (chunk_t)))
-        {
-        return (size_node_t *) __get_mem_block (chunk);
-        }
 
-    /* please refer to the comments for size_nodes in the struct defination */
+    /* only big chunks are in the rbtree, see __is_small */
 
-    return &heap->size_nodes [(chunk->size - sizeof (chunk_t)) / ALLOC_ALIGN - 1];
+    return (size_node_t *) __get_mem_block (chunk);
     }
 
 /**
- * __put_size_node - put the size node for a given size
- * @heap: the given heap
- * @sn:   the size node to put
+ * __is_small - check if a chunk size is kept in the small lists
+ * @size: the chunk size, including the chunk head
  *
- * return: NA
+ * return: true if kept in heap->smalls [], false if in the rbtree
  */
 
-static inline void __put_size_node (heap_t * heap, size_node_t  * sn)
+static inline bool __is_small (size_t size)
     {
+    return size <= sizeof (chunk_t) + HEAP_SMALL_MAX;
+    }
+
+/**
+ * __small_idx - get the index in heap->smalls [] for a chunk size
+ * @size: the chunk size, including the chunk head, greater than the head
+ *
+ * return: the index
+ */
 
-    /* do nothing, refer to __get_size_node */
+static inline unsigned int __small_idx (size_t size)
+    {
+    return (unsigned int) ((size - sizeof (chunk_t)) / ALLOC_ALIGN - 1);
+    }
 
-    return;
+static inline unsigned int __ffs (uint32_t x)
+    {
+    return 31 - __clz (x & (~x + 1));
     }
 
 /**
@@ -221,22 +246,48 @@ static inline void __set_chunk_for_mb (char * mem, chunk_t * chunk)
     }
 
 /**
- * __get_bi_node - bi_node create routine for binary search tree
- * @key: the key value
- * @arg: the chunk the node is created for (from)
+ * __rb_put_chunk - put a free chunk to the sizes rbtree of a heap
+ * @heap:  the given heap
+ * @chunk: the chunk to insert
  *
- * return: the bi_node for the chunk
+ * return: NA
  */
 
-static bi_node_t * __get_bi_node (uintptr_t key, uintptr_t arg)
+static inline void __rb_put_chunk (heap_t * heap, chunk_t * chunk)
     {
-    chunk_t     * chunk = (chunk_t *) arg;
-    size_node_t * szn   = __get_size_node (chunk->heap, chunk);
+    size_node_t * szn;
+    size_node_t * old;
+    unsigned int  idx;
+
+    if (__is_small (chunk->size))
+        {
+        idx = __small_idx (chunk->size);
+
+        dlist_add (&heap->smalls [idx], &chunk->node);
+
+        heap->small_map |= 1u << idx;
+
+        return;
+        }
+
+    /*
+     * the memory block of the chunk becomes the size node if no chunk of the
+     * same size is free, otherwise it is just linked to the existing one
+     */
 
-    szn->size = key;
-    dlist_init (&szn->list);
+    szn       = __get_size_node (heap, chunk);
+    szn->size = chunk->size;
+
+    if ((old = __sizes_insert (&heap->sizes, szn)) != NULL)
+        {
+        szn = old;
+        }
+    else
+        {
+        dlist_init (&szn->list);
+        }
 
-    return &szn->node.bin;
+    dlist_add (&szn->list, &chunk->node);
     }
 
 /**
@@ -249,9 +300,6 @@ static bi_node_t * __get_bi_node (uintptr_t key, uintptr_t arg)
 
 static inline void __put_chunk (heap_t * heap, chunk_t * chunk)
     {
-    rb_node_t   * rbn;
-    size_node_t * szn;
-
 #ifdef HEAP_DEBUG
     if (chunk->size & ALLOC_ALIGN_MASK)
         {
@@ -263,12 +311,14 @@ static inline void __put_chunk (heap_t * heap, chunk_t * chunk)
 
     chunk->heap = heap;
 
-    rbn = rb_node_get (&heap->sizes, (uintptr_t) chunk->size, __get_bi_node,
-                       (uintptr_t) chunk);
-
-    szn = container_of (rbn, size_node_t, node);
-
-    dlist_add (&szn->list, &chunk->node);
+    if (heap->type == HEAP_TYPE_TLSF)
+        {
+        tlsf_put_chunk (heap->tlsf, chunk);
+        }
+    else
+        {
+        __rb_put_chunk (heap, chunk);
+        }
 
 #ifdef INCLUDE_MEM_STATISTICS
     heap->stat.free_chunks++;
@@ -277,34 +327,33 @@ static inline void __put_chunk (heap_t * heap, chunk_t * chunk)
     }
 
 /**
- * __del_chunk - delete a chunk from a heap (for allocating or merging)
+ * __rb_del_chunk - delete a chunk from the sizes rbtree of a heap
  * @heap:  the given heap
  * @chunk: the chunk to delete
  *
  * return: NA
  */
 
-static inline void __del_chunk (heap_t * heap, chunk_t * chunk)
+static inline void __rb_del_chunk (heap_t * heap, chunk_t * chunk)
     {
     dlist_t     * prev = chunk->node.prev;
     size_node_t * sn;
     size_node_t * nsn;
+    unsigned int  idx;
 
-    /* do not set 'chunk->heap' and 'chunk->head' it's not necessarily allocating */
-
-#ifdef INCLUDE_MEM_STATISTICS
-    heap->stat.free_chunks--;
-    heap->stat.free_size -= (chunk->size - sizeof (chunk_t));
-#endif
+    dlist_del (&chunk->node);
 
-#ifdef HEAP_DEBUG
-    if (chunk->size & ALLOC_ALIGN_MASK)
+    if (__is_small (chunk->size))
         {
-        __bug ();
-        }
-#endif
+        idx = __small_idx (chunk->size);
 
-    dlist_del (&chunk->node);
+        if (dlist_empty (&heap->smalls [idx]))
+            {
+            heap->small_map &= ~(1u << idx);
+            }
+
+        return;
+        }
 
     if (dlist_empty (prev))
         {
@@ -313,9 +362,7 @@ static inline void __del_chunk (heap_t * heap, chunk_t * chunk)
 
         sn = container_of (prev, size_node_t, list);
 
-        rb_delete (&heap->sizes, &sn->node);
-
-        __put_size_node (heap, sn);
+        __sizes_delete (&heap->sizes, sn);
 
 #ifdef HEAP_DEBUG
     memset (__get_mem_block (chunk), 0xac, chunk->size - sizeof (chunk_t));
@@ -325,7 +372,7 @@ static inline void __del_chunk (heap_t * heap, chunk_t * chunk)
         }
 
     /*
-     * as most of size nodes are allocated in the memory block of chuck, we may
+     * as the size nodes are allocated in the memory block of chunks, we may
      * deleting a chunk that is just holding the size node, this can only happen
      * when merging free blocks, because chunk are always added from head, so the
      * chunk holds the size node are always the last one, but we are always get
@@ -334,13 +381,6 @@ static inline void __del_chunk (heap_t * heap, chunk_t * chunk)
      * here check this condition and carefully handle it
      */
 
-    /* if size node is from heap->size_nodes [], do nothing */
-
-    if (chunk->size <= sizeof (chunk_t) + sizeof (size_node_t))
-        {
-        return;
-        }
-
     sn = (size_node_t *) __get_mem_block (chunk);
 
     /*
@@ -382,13 +422,47 @@ static inline void __del_chunk (heap_t * heap, chunk_t * chunk)
 
     nsn->size = sn->size;
 
-    rb_replace (&heap->sizes, &sn->node, &nsn->node);
+    crb_replace (&heap->sizes, &sn->node, &nsn->node);
 
 #ifdef HEAP_DEBUG
     memset (__get_mem_block (chunk), 0xac, chunk->size - sizeof (chunk_t));
 #endif
     }
 
+/**
+ * __del_chunk - delete a chunk from a heap (for allocating or merging)
+ * @heap:  the given heap
+ * @chunk: the chunk to delete
+ *
+ * return: NA
+ */
+
+static inline void __del_chunk (heap_t * heap, chunk_t * chunk)
+    {
+    /* do not set 'chunk->heap' and 'chunk->head' it's not necessarily allocating */
+
+#ifdef INCLUDE_MEM_STATISTICS
+    heap->stat.free_chunks--;
+    heap->stat.free_size -= (chunk->size - sizeof (chunk_t));
+#endif
+
+#ifdef HEAP_DEBUG
+    if (chunk->size & ALLOC_ALIGN_MASK)
+        {
+        __bug ();
+        }
+#endif
+
+    if (heap->type == HEAP_TYPE_TLSF)
+        {
+        tlsf_del_chunk (heap->tlsf, chunk);
+        }
+    else
+        {
+        __rb_del_chunk (heap, chunk);
+        }
+    }
+
 /**
  * __get_chunk - get a proper chunk in the heap
  * @heap:  the heap to allocate from
@@ -399,18 +473,52 @@ static inline void __del_chunk (heap_t * heap, chunk_t * chunk)
 
 static inline chunk_t * __get_chunk (heap_t * heap, size_t bytes)
     {
-    rb_node_t * rbn = rb_find_ge (&heap->sizes, bytes + sizeof (chunk_t));
-    chunk_t   * chunk;
+    size_node_t * szn;
+    chunk_t     * chunk;
+    uint32_t      map;
+    size_t        size = bytes + sizeof (chunk_t);
 
-    if (rbn == NULL)
+    if (heap->type == HEAP_TYPE_TLSF)
         {
-        return NULL;
+        chunk = tlsf_get_chunk (heap->tlsf, size);
+
+        if (chunk == NULL)
+            {
+            return NULL;
+            }
+
+#ifdef INCLUDE_MEM_STATISTICS
+        heap->stat.free_chunks--;
+        heap->stat.free_size -= (chunk->size - sizeof (chunk_t));
+#endif
         }
+    else
+        {
+
+        /* the lowest non-empty small list big enough is the best fit */
+
+        map = __is_small (size) ?
+              heap->small_map & ~((1u << __small_idx (size)) - 1) : 0;
+
+        if (map != 0)
+            {
+            chunk = container_of (heap->smalls [__ffs (map)].next, chunk_t,
+                                  node);
+            }
+        else
+            {
+            szn = __sizes_find_ge (&heap->sizes, size);
 
-    chunk = container_of (container_of (rbn, size_node_t, node)->list.next,
-                          chunk_t, node);
+            if (szn == NULL)
+                {
+                return NULL;
+                }
 
-    __del_chunk (heap, chunk);
+            chunk = container_of (szn->list.next, chunk_t, node);
+            }
+
+        __del_chunk (heap, chunk);
+        }
 
     chunk->heap = heap;
     chunk->head = chunk;
@@ -464,11 +572,38 @@ int heap_add (heap_t * heap, char * buff, size_t size)
         return -1;
         }
 
+    if ((heap->type == HEAP_TYPE_TLSF) && (size >= TLSF_MAX_SIZE))
+        {
+        return -1;
+        }
+
     if ((ret = mutex_lock (&heap->mux)) != 0)
         {
         return ret;
         }
 
+    /*
+     * the index of a tlsf heap is kept in the front of the first block, so a
+     * heap_t does not pay for the backend it does not use
+     */
+
+    if ((heap->type == HEAP_TYPE_TLSF) && (heap->tlsf == NULL))
+        {
+        if (size < round_up (sizeof (tlsf_t), ALLOC_ALIGN) + MIN_HEAP_SIZE)
+            {
+            (void) mutex_unlock (&heap->mux);
+
+            return -1;
+            }
+
+        heap->tlsf = (tlsf_t *) buff;
+
+        tlsf_init (heap->tlsf);
+
+        buff += round_up (sizeof (tlsf_t), ALLOC_ALIGN);
+        size -= round_up (sizeof (tlsf_t), ALLOC_ALIGN);
+        }
+
     /*
      * this block of memory will be initialized as:
      *
@@ -703,42 +838,60 @@ static inline void __carve_tail (heap_t * heap, char * mem, size_t size)
     __put_chunk (heap, new_chunk);
     }
 
+#ifdef HEAP_TRACE
+
+struct heap_trace_rec heap_trace_ring [HEAP_TRACE_RECS];
+uint32_t              heap_trace_seq = 0;
+
 /**
- * heap_alloc_align - allocate a block of memory from a heap with alignment
- * @heap:  the heap to allocate from
- * @bytes: size of memory in bytes to allocate
- * @align: the expected alignment value
+ * __heap_trace - record a heap operation in heap_trace_ring
+ * @op:     HEAP_TRACE_ALLOC, HEAP_TRACE_FREE or HEAP_TRACE_REALLOC
+ * @caller: the return address of the caller
+ * @mem:    the memory allocated or freed
+ * @size:   the size of the memory
  *
- * return: the allocated memory block or NULL if fail
+ * return: NA
  */
 
-char * heap_alloc_align (heap_t * heap, size_t align, size_t bytes)
+static void __heap_trace (unsigned int op, void * caller, char * mem,
+                          size_t size)
     {
-    chunk_t * chunk;
-    char    * mem = NULL;
+    struct heap_trace_rec * rec;
+    uint32_t                time = (uint32_t) sysclk_cycles ();
+    unsigned long           flags;
 
-    if (heap == NULL)
-        {
-        return NULL;
-        }
+    flags = int_lock ();
 
-    /* align must be power of 2 */
+    rec = &heap_trace_ring [heap_trace_seq++ % HEAP_TRACE_RECS];
 
-    if (align & (align - 1))
-        {
-        return NULL;
-        }
+    rec->time    = time;
+    rec->size_op = (uint32_t) (size << 2) | op;
+    rec->caller  = (uintptr_t) caller;
+    rec->mem     = (uintptr_t) mem;
+    rec->task    = (uintptr_t) current;
 
-    bytes = unlikely (bytes == 0) ? 1 : bytes;
+    int_unlock (flags);
+    }
 
-    align = unlikely (align < ALLOC_ALIGN) ? ALLOC_ALIGN : align;
+#else
+#define __heap_trace(op, caller, mem, size)     do {} while (0)
+#endif
 
-    bytes = round_up (bytes, ALLOC_ALIGN);
+/**
+ * __heap_alloc_align - allocate a block of memory with alignment, the mutex of
+ *                      the heap must have been taken
+ * @heap:  the heap to allocate from
+ * @align: the expected alignment value, power of 2 and not less than
+ *         ALLOC_ALIGN
+ * @bytes: size of memory in bytes to allocate, rounded up to ALLOC_ALIGN
+ *
+ * return: the allocated memory block or NULL if fail
+ */
 
-    if (mutex_lock (&heap->mux))
-        {
-        return NULL;
-        }
+static char * __heap_alloc_align (heap_t * heap, size_t align, size_t bytes)
+    {
+    chunk_t * chunk;
+    char    * mem;
 
     /* find a big enough memory chunk */
 
@@ -746,7 +899,7 @@ char * heap_alloc_align (heap_t * heap, size_t align, size_t bytes)
 
     if (chunk == NULL)
         {
-        goto out;
+        return NULL;
         }
 
     mem = __carve_head (heap, __get_mem_block (chunk), align);
@@ -767,48 +920,23 @@ char * heap_alloc_align (heap_t * heap, size_t align, size_t bytes)
         }
 #endif
 
-out:
-    mutex_unlock (&heap->mux);
-
     return mem;
     }
 
 /**
- * heap_alloc - allocate a block of memory from a heap
- * @heap:  the heap to allocate from
- * @bytes: size of memory in bytes to allocate
- *
- * return: the allocated memory block or NULL if fail
- */
-
-char * heap_alloc (heap_t * heap, size_t bytes)
-    {
-    return heap_alloc_align (heap, ALLOC_ALIGN, bytes);
-    }
-
-/**
- * heap_free - free a block of memory
- * @heap:  the heap to allocate from
+ * __heap_free - free a block of memory, the mutex of the heap must have been
+ *               taken
+ * @heap: the heap the memory belongs to
+ * @mem:  the memory to free
  *
  * return: NA
  */
 
-void heap_free (char * mem)
+static void __heap_free (heap_t * heap, char * mem)
     {
-    chunk_t      * chunk;
-    heap_t * heap;
-    chunk_t      * prev_chunk;
-    chunk_t      * next_chunk;
-
-    /* ANSI C - free of NULL is OK */
-
-    if (unlikely (mem == NULL))
-        {
-        return;
-        }
-
-    chunk = __get_chunk_for_mb (mem);
-    heap  = chunk->heap;
+    chunk_t * chunk = __get_chunk_for_mb (mem);
+    chunk_t * prev_chunk;
+    chunk_t * next_chunk;
 
 #ifdef HEAP_DEBUG
     if (chunk->head != chunk)
@@ -848,34 +976,466 @@ void heap_free (char * mem)
     }
 
 /**
- * heap_realloc - realloc memory from a heap
- * @heap: the heap to allocate from
- * @ptr:  the original memory
- * @size: the new size
+ * __heap_isr_service - free the memory deferred and refill the isr caches, the
+ *                      mutex of the heap must have been taken
+ * @heap: the heap
  *
- * return: the allocated memory block or NULL if fail
+ * return: NA
  */
 
-char * heap_realloc (heap_t * heap, char * ptr, size_t size)
+static void __heap_isr_service (heap_t * heap)
     {
-    size_t align;
-    char * mem;
-    size_t usable_size;
+    struct heap_isr_cache * cache;
+    unsigned long           flags;
+    void                  * list;
+    void                  * mem;
+    int                     i;
 
-    if (!ptr)
+    if (heap->deferred != NULL)
         {
-        return heap_alloc (heap, size);
+        flags          = int_lock ();
+        list           = heap->deferred;
+        heap->deferred = NULL;
+        int_unlock (flags);
+
+        while (list != NULL)
+            {
+            mem  = list;
+            list = *(void **) list;
+
+            __heap_free (heap, (char *) mem);
+            }
         }
 
-    if (!size)
+    for (i = 0; i < HEAP_NR_ISR_CACHES; i++)
         {
-        heap_free (ptr);
-        return NULL;
-        }
+        cache = &heap->isr_caches [i];
 
-    size = round_up (size, ALLOC_ALIGN);
+        while (cache->nr < cache->target)
+            {
+            mem = __heap_alloc_align (heap, ALLOC_ALIGN, cache->size);
+
+            if (mem == NULL)
+                {
+                break;
+                }
+
+            flags          = int_lock ();
+            *(void **) mem = cache->list;
+            cache->list    = mem;
+            cache->nr++;
+            int_unlock (flags);
+            }
 
-    usable_size = __get_avail_size (ptr);
+        while (cache->nr > cache->target)
+            {
+            flags = int_lock ();
+
+            /* an isr may have taken the blocks since the check above */
+
+            if ((cache->nr <= cache->target) || (cache->list == NULL))
+                {
+                int_unlock (flags);
+                break;
+                }
+
+            mem         = cache->list;
+            cache->list = *(void **) mem;
+            cache->nr--;
+            int_unlock (flags);
+
+            __heap_free (heap, (char *) mem);
+            }
+        }
+    }
+
+/**
+ * heap_alloc_ra - allocate a block of memory from a heap with alignment for a
+ *                 caller
+ * @heap:  the heap to allocate from
+ * @align: the expected alignment value
+ * @bytes: size of memory in bytes to allocate
+ * @ra:    the return address of the caller, recorded with HEAP_TRACE
+ *
+ * return: the allocated memory block or NULL if fail
+ */
+
+char * heap_alloc_ra (heap_t * heap, size_t align, size_t bytes, void * ra)
+    {
+    char * mem;
+
+    if (heap == NULL)
+        {
+        return NULL;
+        }
+
+    /* align must be power of 2 */
+
+    if (align & (align - 1))
+        {
+        return NULL;
+        }
+
+    bytes = unlikely (bytes == 0) ? 1 : bytes;
+
+    align = unlikely (align < ALLOC_ALIGN) ? ALLOC_ALIGN : align;
+
+    bytes = round_up (bytes, ALLOC_ALIGN);
+
+    if (mutex_lock (&heap->mux))
+        {
+        return NULL;
+        }
+
+    __heap_isr_service (heap);
+
+    mem = __heap_alloc_align (heap, align, bytes);
+
+    mutex_unlock (&heap->mux);
+
+    __heap_trace (HEAP_TRACE_ALLOC, ra, mem, bytes);
+
+    return mem;
+    }
+
+/**
+ * heap_alloc_align - allocate a block of memory from a heap with alignment
+ * @heap:  the heap to allocate from
+ * @align: the expected alignment value
+ * @bytes: size of memory in bytes to allocate
+ *
+ * return: the allocated memory block or NULL if fail
+ */
+
+char * heap_alloc_align (heap_t * heap, size_t align, size_t bytes)
+    {
+    return heap_alloc_ra (heap, align, bytes, __ret_addr ());
+    }
+
+/**
+ * heap_alloc - allocate a block of memory from a heap
+ * @heap:  the heap to allocate from
+ * @bytes: size of memory in bytes to allocate
+ *
+ * return: the allocated memory block or NULL if fail
+ */
+
+char * heap_alloc (heap_t * heap, size_t bytes)
+    {
+    return heap_alloc_ra (heap, ALLOC_ALIGN, bytes, __ret_addr ());
+    }
+
+/**
+ * heap_free_ra - free a block of memory for a caller, can be invoked in isr,
+ *                the memory is put to the deferred list of the heap if the
+ *                mutex can not be taken, and freed in the next heap operation
+ *                in task context
+ * @mem: the memory to free
+ * @ra:  the return address of the caller, recorded with HEAP_TRACE
+ *
+ * return: NA
+ */
+
+void heap_free_ra (char * mem, void * ra)
+    {
+    heap_t      * heap;
+    unsigned long flags;
+
+    /* ANSI C - free of NULL is OK */
+
+    if (unlikely (mem == NULL))
+        {
+        return;
+        }
+
+    __heap_trace (HEAP_TRACE_FREE, ra, mem, __get_avail_size (mem));
+
+    heap = __get_chunk_for_mb (mem)->heap;
+
+    if (mutex_lock (&heap->mux) != 0)
+        {
+        flags          = int_lock ();
+        *(void **) mem = heap->deferred;
+        heap->deferred = mem;
+        int_unlock (flags);
+
+        return;
+        }
+
+    __heap_free (heap, mem);
+
+    __heap_isr_service (heap);
+
+    mutex_unlock (&heap->mux);
+    }
+
+/**
+ * heap_free - free a block of memory, can be invoked in isr, see heap_free_ra
+ * @mem: the memory to free
+ *
+ * return: NA
+ */
+
+void heap_free (char * mem)
+    {
+    heap_free_ra (mem, __ret_addr ());
+    }
+
+/**
+ * heap_isr_alloc - allocate a block of memory from the isr caches of a heap,
+ *                  never blocks, can be invoked in isr
+ * @heap:  the heap to allocate from
+ * @bytes: size of memory in bytes to allocate
+ *
+ * return: the allocated memory block or NULL if no cached block big enough
+ */
+
+char * heap_isr_alloc (heap_t * heap, size_t bytes)
+    {
+    struct heap_isr_cache * cache;
+    struct heap_isr_cache * best = NULL;
+    unsigned long           flags;
+    void                  * mem  = NULL;
+    int                     i;
+
+    if (heap == NULL)
+        {
+        return NULL;
+        }
+
+    /*
+     * pick the cache and pop the block with the interrupts locked, so a nested
+     * isr can not drain the cache picked, there are only a few caches
+     */
+
+    flags = int_lock ();
+
+    for (i = 0; i < HEAP_NR_ISR_CACHES; i++)
+        {
+        cache = &heap->isr_caches [i];
+
+        if ((cache->size < bytes) || (cache->nr == 0))
+            {
+            continue;
+            }
+
+        if ((best == NULL) || (cache->size < best->size))
+            {
+            best = cache;
+            }
+        }
+
+    if (best != NULL)
+        {
+        mem        = best->list;
+        best->list = *(void **) mem;
+        best->nr--;
+        }
+
+    int_unlock (flags);
+
+    return (char *) mem;
+    }
+
+/**
+ * heap_isr_reserve - keep a number of blocks of a size for heap_isr_alloc, the
+ *                    caches are refilled in task context heap operations
+ * @heap:  the heap
+ * @bytes: size of the blocks
+ * @nr:    number of blocks to keep, 0 to give back the blocks cached
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int heap_isr_reserve (heap_t * heap, size_t bytes, unsigned int nr)
+    {
+    struct heap_isr_cache * cache = NULL;
+    int                     i;
+    int                     ret;
+
+    if ((heap == NULL) || (bytes == 0))
+        {
+        return -1;
+        }
+
+    bytes = round_up (bytes, ALLOC_ALIGN);
+
+    if ((ret = mutex_lock (&heap->mux)) != 0)
+        {
+        return ret;
+        }
+
+    for (i = 0; i < HEAP_NR_ISR_CACHES; i++)
+        {
+        if (heap->isr_caches [i].size == bytes)
+            {
+            cache = &heap->isr_caches [i];
+            break;
+            }
+
+        if ((cache == NULL) && (heap->isr_caches [i].size == 0))
+            {
+            cache = &heap->isr_caches [i];
+            }
+        }
+
+    if (cache == NULL)
+        {
+        mutex_unlock (&heap->mux);
+        return -1;
+        }
+
+    cache->size   = bytes;
+    cache->target = nr;
+
+    __heap_isr_service (heap);
+
+    ret = cache->nr == nr ? 0 : -1;
+
+    if (nr == 0)
+        {
+        cache->size = 0;
+        }
+
+    mutex_unlock (&heap->mux);
+
+    return ret;
+    }
+
+/**
+ * __realloc_in_place - grow an allocated memory block into the free chunks
+ *                      around it, the mutex of the heap must have been taken
+ * @heap:  the heap of the memory
+ * @ptr:   the memory to grow
+ * @size:  the new size, rounded up to ALLOC_ALIGN and greater than the usable
+ *         size of the memory
+ * @align: the alignment to keep
+ *
+ * return: the memory grown (may be moved backward) or NULL if not possible
+ */
+
+static char * __realloc_in_place (heap_t * heap, char * ptr, size_t size,
+                                  size_t align)
+    {
+    chunk_t * chunk       = __get_chunk_for_mb (ptr);
+    chunk_t * prev_chunk  = __get_prev_chunk (chunk);
+    chunk_t * next_chunk  = __get_next_chunk (chunk);
+    size_t    usable_size = __get_avail_size (ptr);
+    size_t    next_size   = 0;
+    bool      slide;
+    char    * end;
+    char    * mem         = ptr;
+#ifdef INCLUDE_MEM_STATISTICS
+    size_t    old_size    = chunk->size;
+#endif
+
+    if (__is_free (next_chunk))
+        {
+        next_size = next_chunk->size;
+        }
+
+    end = ((char *) next_chunk) + next_size;
+
+    /* extend forward if possible, or slide backward with the previous chunk */
+
+    if (usable_size + next_size >= size)
+        {
+        slide = false;
+        }
+    else if (__is_free (prev_chunk) &&
+             (end - (char *) round_up (__get_mem_block (prev_chunk), align) >=
+              (ptrdiff_t) size))
+        {
+        slide = true;
+        }
+    else
+        {
+        return NULL;
+        }
+
+    if (next_size != 0)
+        {
+        __del_chunk (heap, next_chunk);
+        chunk->size += next_size;
+        }
+
+    if (slide)
+        {
+        __del_chunk (heap, prev_chunk);
+
+        prev_chunk->size += chunk->size;
+        prev_chunk->heap  = heap;
+        prev_chunk->head  = prev_chunk;
+
+        chunk = prev_chunk;
+        }
+
+    __get_next_chunk (chunk)->prev_size = chunk->size;
+
+    if (slide)
+        {
+
+        /*
+         * the new chunk head is in front of ptr, so it never overlaps the data,
+         * the free chunks carved after moving may overlap the old data
+         */
+
+        mem = __carve_head (heap, __get_mem_block (chunk), align);
+
+        memmove (mem, ptr, usable_size);
+        }
+
+    __carve_tail (heap, mem, size);
+
+#ifdef INCLUDE_MEM_STATISTICS
+    heap->stat.busy_size += __get_chunk_for_mb (mem)->size - old_size;
+
+    if (heap->stat.busy_size > heap->stat.max_busy_size)
+        {
+        heap->stat.max_busy_size = heap->stat.busy_size;
+        }
+#endif
+
+    return mem;
+    }
+
+/**
+ * heap_realloc_ra - realloc memory from a heap for a caller
+ * @heap: the heap to allocate from
+ * @ptr:  the original memory
+ * @size: the new size
+ * @ra:   the return address of the caller, recorded with HEAP_TRACE
+ *
+ * return: the allocated memory block or NULL if fail
+ */
+
+char * heap_realloc_ra (heap_t * heap, char * ptr, size_t size, void * ra)
+    {
+    size_t align;
+    char * mem;
+    size_t usable_size;
+
+    if (!ptr)
+        {
+        return heap_alloc_ra (heap, ALLOC_ALIGN, size, ra);
+        }
+
+    if (!size)
+        {
+        heap_free_ra (ptr, ra);
+        return NULL;
+        }
+
+    size = round_up (size, ALLOC_ALIGN);
+
+    if (mutex_lock (&heap->mux))
+        {
+        return NULL;
+        }
+
+    __heap_isr_service (heap);
+
+    usable_size = __get_avail_size (ptr);
 
     if (usable_size >= size)
         {
@@ -888,16 +1448,19 @@ char * heap_realloc (heap_t * heap, char * ptr, size_t size)
 #ifdef  INCLUDE_MEM_STATISTICS
         carved_size = usable_size - __get_avail_size (ptr);
 
-        if (carved_size == 0)
+        if (carved_size != 0)
             {
-            return ptr;
+            heap->stat.busy_size -= carved_size;
+            heap->stat.cum_freed++;
+            heap->stat.cum_size_freed += carved_size;
             }
-
-        heap->stat.busy_size -= carved_size;
-        heap->stat.cum_freed++;
-        heap->stat.cum_size_freed += carved_size;
 #endif  /* INCLUDE_MEM_STATISTICS */
 
+        mutex_unlock (&heap->mux);
+
+        __heap_trace (HEAP_TRACE_FREE, ra, ptr, usable_size);
+        __heap_trace (HEAP_TRACE_REALLOC, ra, ptr, size);
+
         return ptr;
         }
 
@@ -906,12 +1469,122 @@ char * heap_realloc (heap_t * heap, char * ptr, size_t size)
     align = ((size_t) ptr) >> 1;
     align = (align ^ (align - 1)) + 1;
 
-    mem   = heap_alloc_align (heap, align, size);
+    /* grow into the free neighbours before falling back to allocate and copy */
 
-    memcpy (mem, ptr, __get_avail_size (ptr));
+    mem   = __realloc_in_place (heap, ptr, size, align);
 
-    heap_free (ptr);
+    if (mem == NULL)
+        {
+        mem = __heap_alloc_align (heap, align, size);
+
+        if (mem != NULL)
+            {
+            memcpy (mem, ptr, usable_size);
+
+            __heap_free (heap, ptr);
+            }
+        }
+
+    mutex_unlock (&heap->mux);
+
+    /* a failed realloc is recorded with NULL and the old block is kept */
+
+    if (mem != NULL)
+        {
+        __heap_trace (HEAP_TRACE_FREE, ra, ptr, usable_size);
+        }
+
+    __heap_trace (HEAP_TRACE_REALLOC, ra, mem, size);
 
     return mem;
     }
 
+/**
+ * heap_realloc - realloc memory from a heap
+ * @heap: the heap to allocate from
+ * @ptr:  the original memory
+ * @size: the new size
+ *
+ * return: the allocated memory block or NULL if fail
+ */
+
+char * heap_realloc (heap_t * heap, char * ptr, size_t size)
+    {
+    return heap_realloc_ra (heap, ptr, size, __ret_addr ());
+    }
+
+/**
+ * heap_frag_get - walk all the chunks of a heap and get the fragmentation
+ *                 information
+ * @heap: the heap
+ * @frag: the information got
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int heap_frag_get (heap_t * heap, struct heap_frag * frag)
+    {
+    dlist_t    * itr;
+    block_t    * cb;
+    chunk_t    * chunk;
+    chunk_t    * end;
+    size_t       size;
+    unsigned int bucket;
+    int          ret;
+
+    if ((heap == NULL) || (frag == NULL))
+        {
+        return -1;
+        }
+
+    memset (frag, 0, sizeof (struct heap_frag));
+
+    if ((ret = mutex_lock (&heap->mux)) != 0)
+        {
+        return ret;
+        }
+
+    dlist_foreach (itr, &heap->blocks)
+        {
+        cb  = container_of (itr, block_t, node);
+        end = (chunk_t *) (((char *) cb) + cb->size - sizeof (chunk_t));
+
+        /* skip the guard chunks at the beginning and the ending */
+
+        for (chunk = __get_next_chunk (cb->chunk_head); chunk < end;
+             chunk = __get_next_chunk (chunk))
+            {
+            size = chunk->size - sizeof (chunk_t);
+
+            if (!__is_free (chunk))
+                {
+                frag->busy_chunks++;
+                frag->busy_size += size;
+
+                continue;
+                }
+
+            frag->free_chunks++;
+            frag->free_size += size;
+
+            if (size > frag->max_free)
+                {
+                frag->max_free = size;
+                }
+
+            bucket = size < 16 ? 0 : 31 - __clz ((uint32_t) size) - 4;
+            bucket = bucket < HEAP_FRAG_BUCKETS ? bucket : HEAP_FRAG_BUCKETS - 1;
+
+            frag->hist [bucket]++;
+            }
+        }
+
+    mutex_unlock (&heap->mux);
+
+    if (frag->free_size != 0)
+        {
+        frag->frag = 100 - (unsigned int) (frag->max_free * 100 / frag->free_size);
+        }
+
+    return 0;
+    }
@@ -0,0 +1,302 @@
+/* heap_bench.c - rbtree and tlsf heap latency benchmark */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+the same pseudo random trace of allocating and freeing is replayed on a heap of
+each type built on the same buffer, so both start with the same layout. then a
+realloc-heavy trace, some buffers keep growing in small steps and are freed
+when big enough, the blocks moved (copied) by heap_realloc are counted. the
+system clock is too coarse to time a single operation, so the operations are
+timed in windows of HBENCH_WINDOW, the worst window reflects the worst-case
+latency and the total gives the average.
+
+the "heapbench" command is only built with RTW_CONFIG_HEAP_BENCH defined (in
+hw_config.h), tools/heapbench does the same comparison on the host.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <wheel/common.h>
+#include <wheel/config.h>
+#include <wheel/cmder.h>
+#include <wheel/heap.h>
+#include <wheel/sysclk.h>
+
+#ifdef RTW_CONFIG_HEAP_BENCH
+
+#undef putchar
+
+/* defines */
+
+#define HBENCH_ARENA_SIZE       2048
+#define HBENCH_SLOTS            16
+#define HBENCH_MAX_ALLOC        120
+#define HBENCH_WINDOW           16
+#define HBENCH_SEED             0x2545f491u
+#define HBENCH_GROW_BUFS        6
+#define HBENCH_GROW_MAX         256
+
+/* typedefs */
+
+struct hbench_result
+    {
+    uint32_t ops;
+    uint32_t fails;
+    uint32_t moves;         /* blocks moved by heap_realloc */
+    uint64_t total;         /* in sysclk cycles */
+    uint64_t worst;         /* in sysclk cycles, of one window */
+    };
+
+/* locals */
+
+static heap_t bench_heap;
+
+static inline uint32_t __bench_rand (uint32_t * seed)
+    {
+    *seed = *seed * 1664525u + 1013904223u;
+
+    return *seed >> 8;
+    }
+
+static int __bench_run (uint8_t type, char * arena, unsigned int ops,
+                        struct hbench_result * res)
+    {
+    char       * slots [HBENCH_SLOTS] = {NULL, };
+    uint32_t     seed = HBENCH_SEED;
+    uint32_t     r;
+    uint64_t     start;
+    uint64_t     delta;
+    unsigned int i;
+    unsigned int idx;
+
+    if ((heap_init_type (&bench_heap, type) != 0) ||
+        (heap_add (&bench_heap, arena, HBENCH_ARENA_SIZE) != 0))
+        {
+        return -1;
+        }
+
+    res->ops   = 0;
+    res->fails = 0;
+    res->moves = 0;
+    res->total = 0;
+    res->worst = 0;
+
+    while (res->ops < ops)
+        {
+        start = sysclk_cycles ();
+
+        for (i = 0; i < HBENCH_WINDOW; i++)
+            {
+            r   = __bench_rand (&seed);
+            idx = r % HBENCH_SLOTS;
+
+            if (slots [idx] != NULL)
+                {
+                heap_free (slots [idx]);
+                slots [idx] = NULL;
+                }
+            else
+                {
+                slots [idx] = heap_alloc (&bench_heap,
+                                          (r >> 4) % HBENCH_MAX_ALLOC + 1);
+
+                if (slots [idx] == NULL)
+                    {
+                    res->fails++;
+                    }
+                }
+            }
+
+        delta = sysclk_cycles () - start;
+
+        res->ops   += HBENCH_WINDOW;
+        res->total += delta;
+
+        if (delta > res->worst)
+            {
+            res->worst = delta;
+            }
+        }
+
+    for (i = 0; i < HBENCH_SLOTS; i++)
+        {
+        if (slots [i] != NULL)
+            {
+            heap_free (slots [i]);
+            }
+        }
+
+    return 0;
+    }
+
+static int __bench_realloc (uint8_t type, char * arena, unsigned int ops,
+                            struct hbench_result * res)
+    {
+    char       * bufs [HBENCH_GROW_BUFS]  = {NULL, };
+    size_t       sizes [HBENCH_GROW_BUFS] = {0, };
+    uint32_t     seed = HBENCH_SEED;
+    uint32_t     r;
+    uint64_t     start;
+    uint64_t     delta;
+    unsigned int i;
+    unsigned int idx;
+    char       * mem;
+
+    if ((heap_init_type (&bench_heap, type) != 0) ||
+        (heap_add (&bench_heap, arena, HBENCH_ARENA_SIZE) != 0))
+        {
+        return -1;
+        }
+
+    res->ops   = 0;
+    res->fails = 0;
+    res->moves = 0;
+    res->total = 0;
+    res->worst = 0;
+
+    while (res->ops < ops)
+        {
+        start = sysclk_cycles ();
+
+        for (i = 0; i < HBENCH_WINDOW; i++)
+            {
+            r   = __bench_rand (&seed);
+            idx = r % HBENCH_GROW_BUFS;
+
+            if (sizes [idx] >= HBENCH_GROW_MAX)
+                {
+                heap_free (bufs [idx]);
+                bufs [idx]  = NULL;
+                sizes [idx] = 0;
+                continue;
+                }
+
+            mem = heap_realloc (&bench_heap, bufs [idx],
+                                sizes [idx] + (r >> 4) % 56 + 8);
+
+            if (mem == NULL)
+                {
+                res->fails++;
+                continue;
+                }
+
+            if ((bufs [idx] != NULL) && (mem != bufs [idx]))
+                {
+                res->moves++;
+                }
+
+            bufs [idx]   = mem;
+            sizes [idx] += (r >> 4) % 56 + 8;
+            }
+
+        delta = sysclk_cycles () - start;
+
+        res->ops   += HBENCH_WINDOW;
+        res->total += delta;
+
+        if (delta > res->worst)
+            {
+            res->worst = delta;
+            }
+        }
+
+    for (i = 0; i < HBENCH_GROW_BUFS; i++)
+        {
+        heap_free (bufs [i]);
+        }
+
+    return 0;
+    }
+
+static void __bench_show (cmder_t * cmder, const char * name,
+                          struct hbench_result * res)
+    {
+    char buff [96];
+
+    sprintf (buff, "%-7s %8u ops %6u fails %8u ns/op avg %8u ns worst/%d ops\n",
+             name, (unsigned int) res->ops, (unsigned int) res->fails,
+             (unsigned int) (sysclk_cycles_to_ns (res->total) / res->ops),
+             (unsigned int) sysclk_cycles_to_ns (res->worst), HBENCH_WINDOW);
+    cmder->putstr (cmder->arg, buff);
+
+    if (res->moves != 0)
+        {
+        sprintf (buff, "%-7s %8u blocks moved by realloc\n", "",
+                 (unsigned int) res->moves);
+        cmder->putstr (cmder->arg, buff);
+        }
+    }
+
+/**
+ * heapbench - compare the latency of rbtree and tlsf heaps on the same trace
+ *
+ * usage: heapbench [ops]
+ */
+
+static int heapbench (cmder_t * cmder, int argc, char * argv [])
+    {
+    unsigned int         ops = 4096;
+    struct hbench_result res;
+    char               * arena;
+
+    if (argc > 1)
+        {
+        ops = (unsigned int) strtoul (argv [1], NULL, 0);
+        }
+
+    if (ops == 0)
+        {
+        cmder->putstr (cmder->arg, "usage: heapbench [ops]\n");
+        return -1;
+        }
+
+    arena = (char *) malloc (HBENCH_ARENA_SIZE);
+
+    if (arena == NULL)
+        {
+        cmder->putstr (cmder->arg, "no memory for the arena\n");
+        return -1;
+        }
+
+    if (__bench_run (HEAP_TYPE_RBTREE, arena, ops, &res) == 0)
+        {
+        __bench_show (cmder, "rbtree", &res);
+        }
+
+    if (__bench_run (HEAP_TYPE_TLSF, arena, ops, &res) == 0)
+        {
+        __bench_show (cmder, "tlsf", &res);
+        }
+
+    cmder->putstr (cmder->arg, "realloc:\n");
+
+    if (__bench_realloc (HEAP_TYPE_RBTREE, arena, ops, &res) == 0)
+        {
+        __bench_show (cmder, "rbtree", &res);
+        }
+
+    if (__bench_realloc (HEAP_TYPE_TLSF, arena, ops, &res) == 0)
+        {
+        __bench_show (cmder, "tlsf", &res);
+        }
+
+    free (arena);
+
+    return 0;
+    }
+
+RTW_CMDER_CMD_DEF ("heapbench", "compare latency of rbtree and tlsf heaps",
+                   heapbench);
+
+#endif  /* RTW_CONFIG_HEAP_BENCH */
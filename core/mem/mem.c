@@ -10,13 +10,38 @@ modification history
 01a,28jul18,cfm  writen
 */
 
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <wheel/config.h>
 #include <wheel/mem.h>
 #include <wheel/heap.h>
+#include <wheel/arena.h>
+#include <wheel/cmder.h>
+
+#undef putchar
 
 heap_t kernel_heap [1] = {0,};
 
+/*
+ * with RTW_BOOT_ARENA_SIZE, malloc takes memory from the boot arena until
+ * mem_boot_done, the objects created at boot are mostly never freed, so they
+ * need no chunk header and no heap searching. free of them is ignored. the
+ * unused tail of the arena is added to the kernel heap in mem_boot_done.
+ */
+
+#ifdef RTW_BOOT_ARENA_SIZE
+static arena_t boot_arena;
+static bool    boot_arena_on = false;
+static heap_t * boot_heap    = NULL;    /* the heap of the arena region */
+#endif
+
 /**
- * mem_init - initialize the memory management
+ * mem_init - initialize the memory management, create a heap for each region
+ *            in system_phys_mem
  *
  * return: 0 on success, negtive value on error
  */
@@ -25,34 +50,440 @@ int mem_init (void)
     {
     struct phys_mem * spm = system_phys_mem;
     int               block_added = 0;
+    heap_t          * heap;
 
     heap_init (kernel_heap);
 
-    while (spm->end)
+    for (; spm->end; spm++)
         {
-        if (heap_add (kernel_heap, spm->start, spm->end - spm->start) == 0)
+        char * start  = spm->start;
+        bool   carved = false;
+
+        spm->heap = NULL;
+
+#ifdef RTW_BOOT_ARENA_SIZE
+        if (!boot_arena_on &&
+            (spm->end - start >= RTW_BOOT_ARENA_SIZE + MIN_HEAP_SIZE))
+            {
+            start = (char *) round_up (start, ALLOC_ALIGN);
+
+            (void) arena_init (&boot_arena, start, RTW_BOOT_ARENA_SIZE);
+
+            boot_arena_on = true;
+            carved        = true;
+            start        += RTW_BOOT_ARENA_SIZE;
+            }
+#endif
+
+        /* the first region added is the kernel heap, the others get new ones */
+
+        heap = kernel_heap;
+
+        if (block_added != 0)
+            {
+            if ((heap = (heap_t *) malloc (sizeof (heap_t))) == NULL)
+                {
+                continue;
+                }
+
+            memset (heap, 0, sizeof (heap_t));
+
+            heap_init (heap);
+            }
+
+        if (heap_add (heap, start, spm->end - start) != 0)
             {
-            block_added++;
+            if (heap != kernel_heap)
+                {
+                free (heap);
+                }
+
+            continue;
             }
 
-        spm++;
+        spm->heap = heap;
+
+#ifdef RTW_BOOT_ARENA_SIZE
+        if (carved)
+            {
+            boot_heap = heap;
+            }
+#else
+        (void) carved;
+#endif
+
+        block_added++;
         }
 
     return block_added == 0 ? -1 : 0;
     }
 
+/**
+ * mem_boot_done - stop allocating from the boot arena, and give the unused
+ *                 memory of it to the kernel heap
+ *
+ * return: NA
+ */
+
+void mem_boot_done (void)
+    {
+#ifdef RTW_BOOT_ARENA_SIZE
+    char * tail;
+
+    if (!boot_arena_on)
+        {
+        return;
+        }
+
+    boot_arena_on = false;
+
+    tail = (char *) round_up (arena_mark (&boot_arena), ALLOC_ALIGN);
+
+    if ((boot_heap == NULL) || ((size_t) (boot_arena.end - tail) < MIN_HEAP_SIZE))
+        {
+        return;
+        }
+
+    if (heap_add (boot_heap, tail, boot_arena.end - tail) == 0)
+        {
+        boot_arena.end = tail;
+        }
+#endif
+    }
+
 void * malloc (size_t size)
     {
-    return heap_alloc (kernel_heap, size);
+#ifdef RTW_BOOT_ARENA_SIZE
+    void * mem;
+
+    if (boot_arena_on && ((mem = arena_alloc (&boot_arena, size)) != NULL))
+        {
+        return mem;
+        }
+#endif
+
+    return heap_alloc_ra (kernel_heap, ALLOC_ALIGN, size, __ret_addr ());
     }
 
 void free (void * ptr)
     {
-    heap_free (ptr);
+#ifdef RTW_BOOT_ARENA_SIZE
+    if (arena_owns (&boot_arena, ptr))
+        {
+        return;     /* objects allocated at boot are never freed */
+        }
+#endif
+
+    heap_free_ra (ptr, __ret_addr ());
     }
 
 void * memalign (size_t alignment,  size_t size)
     {
-    return heap_alloc_align (kernel_heap, alignment, size);
+#ifdef RTW_BOOT_ARENA_SIZE
+    void * mem;
+
+    if (boot_arena_on &&
+        ((mem = arena_alloc_align (&boot_arena, alignment, size)) != NULL))
+        {
+        return mem;
+        }
+#endif
+
+    return heap_alloc_ra (kernel_heap, alignment, size, __ret_addr ());
+    }
+
+/**
+ * __mem_alloc_pass - allocate from the first region having all the attributes
+ * @attr:  the attributes the region must have
+ * @align: the expected alignment value, power of 2
+ * @size:  size of memory in bytes to allocate
+ * @ra:    return address of the caller, for the heap trace
+ *
+ * return: the allocated memory block or NULL if fail
+ */
+
+static void * __mem_alloc_pass (unsigned int attr, size_t align, size_t size,
+                                void * ra)
+    {
+    struct phys_mem * spm;
+    void            * mem;
+
+    for (spm = system_phys_mem; spm->end; spm++)
+        {
+        if ((spm->heap == NULL) || ((spm->attr & attr) != attr))
+            {
+            continue;
+            }
+
+        if ((mem = heap_alloc_ra (spm->heap, align, size, ra)) != NULL)
+            {
+            return mem;
+            }
+        }
+
+    return NULL;
+    }
+
+/**
+ * __mem_alloc_align - allocate memory with a placement hint
+ * @attr:  the hint, MEM_ATTR_* ored
+ * @align: the expected alignment value, power of 2
+ * @size:  size of memory in bytes to allocate
+ * @ra:    return address of the caller, for the heap trace
+ *
+ * the regions are tried in the order of system_phys_mem, first the ones with
+ * all the attributes in <attr>, then, if <attr> has MEM_ATTR_FAST, the ones
+ * with only the required attributes (MEM_ATTR_REQUIRED) in <attr>. so hot data
+ * falls back to slower memory, but dma buffers never go to memory not
+ * reachable by dma.
+ *
+ * return: the allocated memory block or NULL if fail
+ */
+
+static void * __mem_alloc_align (unsigned int attr, size_t align, size_t size,
+                                 void * ra)
+    {
+    void * mem;
+
+    if ((mem = __mem_alloc_pass (attr, align, size, ra)) != NULL)
+        {
+        return mem;
+        }
+
+    if ((attr & ~MEM_ATTR_REQUIRED) == 0)
+        {
+        return NULL;
+        }
+
+    return __mem_alloc_pass (attr & MEM_ATTR_REQUIRED, align, size, ra);
+    }
+
+/**
+ * mem_alloc_align - allocate memory with a placement hint and alignment, see
+ *                   __mem_alloc_align for the fallback order
+ * @attr:  the hint, MEM_ATTR_* ored
+ * @align: the expected alignment value, power of 2
+ * @size:  size of memory in bytes to allocate
+ *
+ * return: the allocated memory block or NULL if fail
+ */
+
+void * mem_alloc_align (unsigned int attr, size_t align, size_t size)
+    {
+    return __mem_alloc_align (attr, align, size, __ret_addr ());
+    }
+
+/**
+ * mem_alloc - allocate memory with a placement hint, see __mem_alloc_align for
+ *             the fallback order
+ * @attr:  the hint, MEM_ATTR_* ored
+ * @size:  size of memory in bytes to allocate
+ *
+ * return: the allocated memory block or NULL if fail
+ */
+
+void * mem_alloc (unsigned int attr, size_t size)
+    {
+    return __mem_alloc_align (attr, ALLOC_ALIGN, size, __ret_addr ());
+    }
+
+/**
+ * mem_heap_get - get the heap of a named memory region
+ * @name: the name of the region in system_phys_mem
+ *
+ * return: the heap or NULL if not found
+ */
+
+heap_t * mem_heap_get (const char * name)
+    {
+    struct phys_mem * spm;
+
+    for (spm = system_phys_mem; spm->end; spm++)
+        {
+        if ((spm->name != NULL) && (strcmp (spm->name, name) == 0))
+            {
+            return spm->heap;
+            }
+        }
+
+    return NULL;
     }
 
+/**
+ * __mem_show_heap - show the statistics and fragmentation of a heap
+ * @cmder: the cmder
+ * @spm:   the memory region of the heap
+ * @hist:  show the free chunk size histogram or not
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+static int __mem_show_heap (cmder_t * cmder, struct phys_mem * spm, bool hist)
+    {
+    heap_t         * heap = spm->heap;
+    struct heap_frag frag;
+    char             buff [96];
+    int              i;
+
+    snprintf (buff, sizeof (buff), "%s [%08x - %08x]%s%s%s%s%s\n",
+              spm->name == NULL ? "-" : spm->name,
+              (unsigned int) (uintptr_t) spm->start,
+              (unsigned int) (uintptr_t) spm->end,
+              spm->attr & MEM_ATTR_FAST     ? " fast"     : "",
+              spm->attr & MEM_ATTR_DMA      ? " dma"      : "",
+              spm->attr & MEM_ATTR_RETAINED ? " retained" : "",
+              spm->attr & MEM_ATTR_UNCACHED ? " uncached" : "",
+              heap == kernel_heap           ? " (kernel)" : "");
+    cmder->putstr (cmder->arg, buff);
+
+    if (heap == NULL)
+        {
+        cmder->putstr (cmder->arg, "no heap\n");
+        return 0;
+        }
+
+    if (heap_frag_get (heap, &frag) != 0)
+        {
+        cmder->putstr (cmder->arg, "fail to walk the heap\n");
+        return -1;
+        }
+
+    snprintf (buff, sizeof (buff), "free:            %u bytes in %u chunks\n",
+              (unsigned int) frag.free_size, frag.free_chunks);
+    cmder->putstr (cmder->arg, buff);
+
+    snprintf (buff, sizeof (buff), "busy:            %u bytes in %u chunks\n",
+              (unsigned int) frag.busy_size, frag.busy_chunks);
+    cmder->putstr (cmder->arg, buff);
+
+    snprintf (buff, sizeof (buff), "largest free:    %u bytes\n",
+              (unsigned int) frag.max_free);
+    cmder->putstr (cmder->arg, buff);
+
+    snprintf (buff, sizeof (buff), "fragmentation:   %u%%\n", frag.frag);
+    cmder->putstr (cmder->arg, buff);
+
+#ifdef INCLUDE_MEM_STATISTICS
+    snprintf (buff, sizeof (buff), "peak busy:       %u bytes\n",
+              (unsigned int) heap->stat.max_busy_size);
+    cmder->putstr (cmder->arg, buff);
+
+    snprintf (buff, sizeof (buff), "allocated/freed: %u/%u\n",
+              (unsigned int) heap->stat.cum_allocated,
+              (unsigned int) heap->stat.cum_freed);
+    cmder->putstr (cmder->arg, buff);
+#endif
+
+    if (!hist)
+        {
+        return 0;
+        }
+
+    /* the first bucket also counts the chunks under 16 bytes */
+
+    for (i = 0; i < HEAP_FRAG_BUCKETS; i++)
+        {
+        if (i == HEAP_FRAG_BUCKETS - 1)
+            {
+            snprintf (buff, sizeof (buff), "  %6u+       : %u\n", 16u << i,
+                      frag.hist [i]);
+            }
+        else
+            {
+            snprintf (buff, sizeof (buff), "  %6u ~ %6u: %u\n",
+                      i == 0 ? 0 : 16u << i, (32u << i) - 1, frag.hist [i]);
+            }
+
+        cmder->putstr (cmder->arg, buff);
+        }
+
+    return 0;
+    }
+
+/**
+ * mem_show - show the statistics and fragmentation of the heaps
+ *
+ * usage: mem [-h] [name], -h to show the free chunk size histogram, name to
+ *        show only the heap of the named memory region
+ */
+
+static int mem_show (cmder_t * cmder, int argc, char * argv [])
+    {
+    struct phys_mem * spm;
+    const char      * name = NULL;
+    bool              hist = false;
+    int               ret  = 0;
+    int               i;
+
+    for (i = 1; i < argc; i++)
+        {
+        if ((argv [i][0] == '-') && (argv [i][1] == 'h'))
+            {
+            hist = true;
+            }
+        else
+            {
+            name = argv [i];
+            }
+        }
+
+    for (spm = system_phys_mem; spm->end; spm++)
+        {
+        if ((name != NULL) &&
+            ((spm->name == NULL) || (strcmp (spm->name, name) != 0)))
+            {
+            continue;
+            }
+
+        if (__mem_show_heap (cmder, spm, hist) != 0)
+            {
+            ret = -1;
+            }
+        }
+
+    return ret;
+    }
+
+RTW_CMDER_CMD_DEF ("mem", "show heap usage and fragmentation, [-h] [name]",
+                   mem_show);
+
+#ifdef HEAP_TRACE
+
+/**
+ * mem_trace - dump the heap trace ring, oldest first, one record per line:
+ *             "@ <time> <op> <task> <caller> <mem> <size>" in hex, to be
+ *             symbolized by tools/heap_trace.py
+ *
+ * usage: memtrace
+ */
+
+static int mem_trace (cmder_t * cmder, int argc, char * argv [])
+    {
+    struct heap_trace_rec rec;
+    uint32_t              seq = heap_trace_seq;
+    uint32_t              i;
+    char                  buff [64];
+
+    i = seq > HEAP_TRACE_RECS ? seq - HEAP_TRACE_RECS : 0;
+
+    snprintf (buff, sizeof (buff), "# heap trace %u records, %u lost\n",
+              (unsigned int) (seq - i), (unsigned int) i);
+    cmder->putstr (cmder->arg, buff);
+
+    for (; i < seq; i++)
+        {
+        rec = heap_trace_ring [i % HEAP_TRACE_RECS];
+
+        snprintf (buff, sizeof (buff), "@ %08x %x %08x %08x %08x %x\n",
+                  (unsigned int) rec.time, (unsigned int) (rec.size_op & 3),
+                  (unsigned int) rec.task, (unsigned int) rec.caller,
+                  (unsigned int) rec.mem, (unsigned int) (rec.size_op >> 2));
+        cmder->putstr (cmder->arg, buff);
+        }
+
+    return 0;
+    }
+
+RTW_CMDER_CMD_DEF ("memtrace", "dump the heap allocation trace", mem_trace);
+
+#endif
@@ -0,0 +1,234 @@
+/* tlsf.c - two-level segregated fit free chunk index */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+this is the free chunk index of the tlsf heaps (HEAP_TYPE_TLSF), the chunks
+themselves (splitting, merging, the headers) are managed by heap.c just like
+the rbtree heaps, only the way to find a free chunk is different.
+
+a free chunk of <size> is put in the list of (fl, sl):
+
+    size <  TLSF_SMALL_SIZE: fl = 0, sl = size / (TLSF_SMALL_SIZE / SL_COUNT)
+    size >= TLSF_SMALL_SIZE: fl = fls (size) - TLSF_FL_SHIFT + 1,
+                             sl = the TLSF_SL_SHIFT bits below the msb
+
+when getting, the wanted size is rounded up to the next list, so any chunk in
+the first non-empty list found by the bitmaps is big enough (good fit, not
+best fit), there is no searching in the lists.
+
+the free lists are linked with chunk->node without list head, the list heads
+are just the pointers in tlsf->heads, to keep tlsf_t small.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <wheel/common.h>
+#include <wheel/heap.h>
+#include <wheel/tlsf.h>
+
+STATIC_ASSERT (TLSF_FL_COUNT > 0);
+STATIC_ASSERT (TLSF_FL_COUNT < 32);
+STATIC_ASSERT ((1 << TLSF_ALIGN_SHIFT) <= ALLOC_ALIGN);
+
+static inline unsigned int __fls (uint32_t x)
+    {
+    return 31 - __clz (x);
+    }
+
+static inline unsigned int __ffs (uint32_t x)
+    {
+    return 31 - __clz (x & (~x + 1));
+    }
+
+/**
+ * __tlsf_mapping - get the list indexes for a size
+ * @size: the size
+ * @fl:   the first level index output
+ * @sl:   the second level index output
+ *
+ * return: NA
+ */
+
+static inline void __tlsf_mapping (size_t size, unsigned int * fl,
+                                   unsigned int * sl)
+    {
+    unsigned int msb;
+
+    if (size < TLSF_SMALL_SIZE)
+        {
+        *fl = 0;
+        *sl = (unsigned int) size / (TLSF_SMALL_SIZE / TLSF_SL_COUNT);
+
+        return;
+        }
+
+    msb = __fls ((uint32_t) size);
+
+    *fl = msb - TLSF_FL_SHIFT + 1;
+    *sl = ((uint32_t) size >> (msb - TLSF_SL_SHIFT)) ^ TLSF_SL_COUNT;
+    }
+
+/**
+ * tlsf_init - initialize a tlsf free chunk index
+ * @tlsf: the index
+ *
+ * return: NA
+ */
+
+void tlsf_init (tlsf_t * tlsf)
+    {
+    unsigned int fl;
+    unsigned int sl;
+
+    tlsf->fl_bmap = 0;
+
+    for (fl = 0; fl < TLSF_FL_COUNT; fl++)
+        {
+        tlsf->sl_bmap [fl] = 0;
+
+        for (sl = 0; sl < TLSF_SL_COUNT; sl++)
+            {
+            tlsf->heads [fl][sl] = NULL;
+            }
+        }
+    }
+
+/**
+ * tlsf_put_chunk - put a free chunk to the index
+ * @tlsf:  the index
+ * @chunk: the free chunk, less than TLSF_MAX_SIZE
+ *
+ * return: NA
+ */
+
+void tlsf_put_chunk (tlsf_t * tlsf, struct chunk * chunk)
+    {
+    struct chunk * head;
+    unsigned int   fl;
+    unsigned int   sl;
+
+    __tlsf_mapping (chunk->size, &fl, &sl);
+
+    head = tlsf->heads [fl][sl];
+
+    chunk->node.prev = NULL;
+    chunk->node.next = head == NULL ? NULL : &head->node;
+
+    if (head != NULL)
+        {
+        head->node.prev = &chunk->node;
+        }
+
+    tlsf->heads [fl][sl] = chunk;
+
+    tlsf->fl_bmap      |= 1u << fl;
+    tlsf->sl_bmap [fl] |= 1u << sl;
+    }
+
+/**
+ * tlsf_del_chunk - delete a free chunk from the index
+ * @tlsf:  the index
+ * @chunk: the free chunk
+ *
+ * return: NA
+ */
+
+void tlsf_del_chunk (tlsf_t * tlsf, struct chunk * chunk)
+    {
+    dlist_t      * prev = chunk->node.prev;
+    dlist_t      * next = chunk->node.next;
+    unsigned int   fl;
+    unsigned int   sl;
+
+    if (next != NULL)
+        {
+        next->prev = prev;
+        }
+
+    if (prev != NULL)
+        {
+        prev->next = next;
+
+        return;
+        }
+
+    /* it is the head of the list */
+
+    __tlsf_mapping (chunk->size, &fl, &sl);
+
+    if (next != NULL)
+        {
+        tlsf->heads [fl][sl] = container_of (next, struct chunk, node);
+
+        return;
+        }
+
+    tlsf->heads [fl][sl] = NULL;
+
+    tlsf->sl_bmap [fl] &= ~(1u << sl);
+
+    if (tlsf->sl_bmap [fl] == 0)
+        {
+        tlsf->fl_bmap &= ~(1u << fl);
+        }
+    }
+
+/**
+ * tlsf_get_chunk - get a free chunk big enough and delete it from the index
+ * @tlsf: the index
+ * @size: the min chunk size wanted
+ *
+ * return: the chunk or NULL if no chunk big enough
+ */
+
+struct chunk * tlsf_get_chunk (tlsf_t * tlsf, size_t size)
+    {
+    struct chunk * chunk;
+    unsigned int   fl;
+    unsigned int   sl;
+    uint32_t       bmap;
+
+    if (size >= TLSF_SMALL_SIZE)
+        {
+        size += (1u << (__fls ((uint32_t) size) - TLSF_SL_SHIFT)) - 1;
+        }
+
+    if (size >= TLSF_MAX_SIZE)
+        {
+        return NULL;
+        }
+
+    __tlsf_mapping (size, &fl, &sl);
+
+    bmap = tlsf->sl_bmap [fl] & (~0u << sl);
+
+    if (bmap == 0)
+        {
+        bmap = tlsf->fl_bmap & (~0u << (fl + 1));
+
+        if (bmap == 0)
+            {
+            return NULL;
+            }
+
+        fl   = __ffs (bmap);
+        bmap = tlsf->sl_bmap [fl];
+        }
+
+    sl    = __ffs (bmap);
+    chunk = tlsf->heads [fl][sl];
+
+    tlsf_del_chunk (tlsf, chunk);
+
+    return chunk;
+    }
@@ -10,16 +10,195 @@ modification history
 01a,16sep18,cfm  writen
 */
 
+/*
+the system clock is a monotonic count of the system timer cycles since it is
+started, the count at the latest tick (<base>) and the raw counter value at
+that tick (<raw>, 0 if the counter is reset every period) are published from
+the tick isr as a pair through a seqlatch, a reader adds the counter elapsed
+since <raw> to <base>, so no lock is needed and the pair is never torn.
+
+for a free running timer (like the nrf51 rtc), the elapsed value is always
+right even if the tick isr is pending or being preempted, so the clock never
+goes back, as long as it is read within the range of the counter since the
+latest tick.
+
+the alarm is a one-shot callback at an absolute cycle count, it is multiplexed
+on the first spare compare channel of the system timer. with a free running
+timer the channel is armed at once if the alarm is in half the counter range,
+otherwise the alarm is re-armed at the ticks until it falls in the current
+period. if the system timer has no spare channel, the alarm is just checked at
+every tick.
+*/
+
 #include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
 
 #include <kernel/tick.h>
+#include <kernel/critical.h>
 
+#include <wheel/common.h>
 #include <wheel/config.h>
 #include <wheel/hal_timer.h>
+#include <wheel/seqlock.h>
+#include <wheel/sysclk.h>
+
+/* the reciprocal multipliers must fit in 32 bits */
+
+STATIC_ASSERT (SYSCLK_CYCLES_PER_TICK > 0);
+STATIC_ASSERT ((1000000000ull << SYSCLK_CYC2NS_SHIFT) / RTW_SYS_TIMER_FREQ <=
+               UINT32_MAX);
+STATIC_ASSERT ((1000000ull << SYSCLK_CYC2US_SHIFT) / RTW_SYS_TIMER_FREQ <=
+               UINT32_MAX);
+STATIC_ASSERT (RTW_SYS_TIMER_FREQ < 1000000);
+
+/* typedefs */
+
+struct sysclk_snap
+    {
+    uint64_t base;                  /* cycles at the latest tick */
+    uint32_t raw;                   /* counter value at the latest tick */
+    };
 
 /* locals */
 
-static hal_timer_t * systim = NULL;
+static hal_timer_t *      systim = NULL;
+static struct sysclk_snap sysclk_snap;      /* only changed in the tick isr */
+static struct sysclk_snap sysclk_snaps [2];
+static seqlatch_t         sysclk_latch = SEQLATCH_INIT;
+
+static volatile bool alarm_pending = false;
+static volatile bool alarm_armed   = false;
+static uint64_t      alarm_at;
+static void       (* alarm_pfn) (uintptr_t) = NULL;
+static uintptr_t     alarm_arg;
+
+/**
+ * __sysclk_read - read the cycle count and the snapshot it is based on
+ * @snap: the snapshot used
+ *
+ * return: the cycle count
+ */
+
+static uint64_t __sysclk_read (struct sysclk_snap * snap)
+    {
+    unsigned int seq;
+    uint32_t     counter;
+
+    do
+        {
+        seq     = seqlatch_read_begin (&sysclk_latch);
+        *snap   = sysclk_snaps [seq & 1];
+        counter = (uint32_t) hal_timer_counter (systim);
+        } while (seqlatch_read_retry (&sysclk_latch, seq));
+
+    /* hal_timer_counter already counts up for a down counting timer */
+
+    if (systim->free_run)
+        {
+        counter = (counter - snap->raw) & (uint32_t) systim->max_count;
+        }
+
+    return snap->base + counter;
+    }
+
+/**
+ * __sysclk_alarm_arm - arm the compare channel for the alarm if it is in the
+ *                      range, must be invoked in critical
+ *
+ * return: NA
+ */
+
+static void __sysclk_alarm_arm (void)
+    {
+    struct sysclk_snap snap;
+    uint64_t           now;
+    uint64_t           cmp;
+
+    alarm_armed = false;
+
+    if (!alarm_pending)
+        {
+        (void) hal_timer_chan_disable (systim, 0);
+
+        return;
+        }
+
+    now = __sysclk_read (&snap);
+
+    if (alarm_at <= now)
+        {
+        alarm_pending = false;
+
+        (void) hal_timer_chan_disable (systim, 0);
+
+        alarm_pfn (alarm_arg);
+
+        return;
+        }
+
+    if (systim->free_run)
+        {
+        if (alarm_at - now > (systim->max_count >> 1))
+            {
+            return;             /* re-armed at the coming ticks */
+            }
+
+        cmp = (snap.raw + (alarm_at - snap.base)) & systim->max_count;
+        }
+    else
+        {
+        if (alarm_at >= snap.base + SYSCLK_CYCLES_PER_TICK)
+            {
+            return;             /* re-armed at the coming ticks */
+            }
+
+        cmp = alarm_at - snap.base;
+        }
+
+    alarm_armed = hal_timer_chan_enable (systim, 0, cmp) == 0;
+    }
+
+static int __sysclk_alarm_rearm (uintptr_t arg1, uintptr_t arg2)
+    {
+    (void) arg1;
+    (void) arg2;
+
+    __sysclk_alarm_arm ();
+
+    return 0;
+    }
+
+static void __sysclk_alarm_isr (uintptr_t arg)
+    {
+    (void) arg;
+
+    (void) do_critical (__sysclk_alarm_rearm, 0, 0);
+    }
+
+static void __sysclk_tick (uintptr_t arg)
+    {
+    (void) arg;
+
+    sysclk_snap.base += SYSCLK_CYCLES_PER_TICK;
+
+    if (systim->free_run)
+        {
+        sysclk_snap.raw = (sysclk_snap.raw + SYSCLK_CYCLES_PER_TICK) &
+                          (uint32_t) systim->max_count;
+        }
+
+    SEQLATCH_PUBLISH (&sysclk_latch, sysclk_snaps, sysclk_snap);
+
+    tick_shot_n (1);
+
+    /* the channel of a timer reset every period is only valid in the period */
+
+    if (alarm_pending && (!alarm_armed || !systim->free_run))
+        {
+        (void) do_critical (__sysclk_alarm_rearm, 0, 0);
+        }
+    }
 
 /**
  * sysclk_init - system clock init
@@ -36,9 +215,18 @@ int sysclk_init (void)
         return -1;
         }
 
-    hal_timer_connect (systim, tick_shot_n, 1);
+    /* the conversions are generated at compile time for this frequency */
+
+    if (systim->freq != RTW_SYS_TIMER_FREQ)
+        {
+        return -1;
+        }
+
+    hal_timer_connect (systim, __sysclk_tick, 0);
 
-    hal_timer_enable (systim, systim->freq / RTW_SYS_TICK_HZ);
+    (void) hal_timer_chan_connect (systim, 0, __sysclk_alarm_isr, 0);
+
+    hal_timer_enable (systim, SYSCLK_CYCLES_PER_TICK);
 
     return 0;
     }
@@ -46,11 +234,113 @@ int sysclk_init (void)
 /**
  * sysclk_timestamp - system clock timestamp get
  *
- * return: NA
+ * return: the monotonic cycle count, same as sysclk_cycles
  */
 
 uint64_t sysclk_timestamp (void)
     {
-    return hal_timer_counter (systim);
+    return sysclk_cycles ();
+    }
+
+/**
+ * sysclk_cycles - get the number of system timer cycles since the system clock
+ *                 started, monotonic and can be invoked in any context
+ *
+ * return: the number of cycles
+ */
+
+uint64_t sysclk_cycles (void)
+    {
+    struct sysclk_snap snap;
+
+    if (systim == NULL)
+        {
+        return 0;
+        }
+
+    return __sysclk_read (&snap);
+    }
+
+/**
+ * sysclk_ns - get the nanoseconds since the system clock started
+ *
+ * return: the nanoseconds
+ */
+
+uint64_t sysclk_ns (void)
+    {
+    return sysclk_cycles_to_ns (sysclk_cycles ());
+    }
+
+/**
+ * sysclk_freq - get the frequency of the system timer
+ *
+ * return: the frequency in hz, 0 if the system clock is not started
+ */
+
+uint32_t sysclk_freq (void)
+    {
+    return systim == NULL ? 0 : (uint32_t) systim->freq;
     }
 
+/**
+ * sysclk_alarm_connect - connect the alarm callback, it is invoked in critical
+ * @pfn: the callback routine
+ * @arg: the argument to the callback routine
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+int sysclk_alarm_connect (void (* pfn) (uintptr_t), uintptr_t arg)
+    {
+    if ((pfn == NULL) || (alarm_pfn != NULL))
+        {
+        return -1;
+        }
+
+    alarm_arg = arg;
+    alarm_pfn = pfn;
+
+    return 0;
+    }
+
+/**
+ * sysclk_alarm_set - set the alarm to fire at the cycle count of <cycles>, an
+ *                    alarm set before is overridden, must be invoked in
+ *                    critical
+ * @cycles: the absolute cycle count got from sysclk_cycles
+ *
+ * return: NA
+ */
+
+void sysclk_alarm_set (uint64_t cycles)
+    {
+    if ((systim == NULL) || (alarm_pfn == NULL))
+        {
+        return;
+        }
+
+    alarm_at      = cycles;
+    alarm_pending = true;
+
+    __sysclk_alarm_arm ();
+    }
+
+/**
+ * sysclk_alarm_cancel - cancel the alarm, must be invoked in critical
+ *
+ * return: NA
+ */
+
+void sysclk_alarm_cancel (void)
+    {
+    if (systim == NULL)
+        {
+        return;
+        }
+
+    alarm_pending = false;
+    alarm_armed   = false;
+
+    (void) hal_timer_chan_disable (systim, 0);
+    }
@@ -0,0 +1,42 @@
+/* cond.h - condition variable library header file */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+#ifndef __COND_H__
+#define __COND_H__
+
+#include <stdint.h>
+
+#include <kernel/task.h>
+#include <kernel/mutex.h>
+
+/* typedefs */
+
+typedef struct cond
+    {
+    mutex_id  mutex;        /* the mutex used by the waiters */
+    pwait_q_t pend_q;
+    } cond_t, * cond_id;
+
+/* defines */
+
+#define COND_INIT(name)         \
+    { NULL, PWAIT_Q_INIT ((name).pend_q) }
+
+/* externs */
+
+extern int cond_init      (cond_id cond);
+extern int cond_wait      (cond_id cond, mutex_id mutex);
+extern int cond_timedwait (cond_id cond, mutex_id mutex, unsigned int timeout);
+extern int cond_signal    (cond_id cond);
+extern int cond_broadcast (cond_id cond);
+
+#endif  /* __COND_H__ */
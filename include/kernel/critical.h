@@ -15,12 +15,34 @@ modification history
 
 #include <stdint.h>
 
+/* defines */
+
+#define KBATCH_MAX_JOBS         8
+
+/* typedefs */
+
+/* critical jobs to be done under one critical entry, see kernel/kbatch.h */
+
+typedef struct kbatch
+    {
+    unsigned int nr;
+    struct
+        {
+        int    (* pfn) (uintptr_t, uintptr_t);
+        uintptr_t arg1;
+        uintptr_t arg2;
+        } jobs [KBATCH_MAX_JOBS];
+    } kbatch_t;
+
+/* externs */
+
 extern int do_critical_might_sleep (int (* job) (uintptr_t, uintptr_t),
                                     uintptr_t arg1, uintptr_t arg2);
 extern int do_critical             (int (* job) (uintptr_t, uintptr_t),
                                     uintptr_t arg1, uintptr_t arg2);
 extern int do_critical_non_irq     (int (* job) (uintptr_t, uintptr_t),
                                     uintptr_t arg1, uintptr_t arg2);
+extern int do_critical_batch       (kbatch_t * batch);
 
 #endif  /* __CRITICAL_H__ */
 
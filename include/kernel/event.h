@@ -22,12 +22,14 @@ typedef struct event
     {
     uint32_t event_set;
     dlist_t  pend_q;
+    dlist_t  sel_q;
     } event_t, * event_id;
 
 /* macros */
 
 #define EVENT_INIT(name)    \
-    { 0, { &(name).pend_q, &(name).pend_q } }
+    { 0, { &(name).pend_q, &(name).pend_q },            \
+      { &(name).sel_q, &(name).sel_q } }
 
 extern int      event_init   (event_id event);
 extern event_id event_create (void);
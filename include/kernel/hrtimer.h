@@ -0,0 +1,47 @@
+/* hrtimer.h - high resolution timer library header file */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+#ifndef __HRTIMER_H__
+#define __HRTIMER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <wheel/list.h>
+
+#include <kernel/task.h>
+
+/* typedefs */
+
+typedef struct hrtimer
+    {
+    dlist_t      node;          /* in the sorted hrtimer queue */
+    bool         active;
+    uint64_t     expiry;        /* in system clock cycles */
+    uint64_t     wanted;        /* expiry requested, set before the start job */
+    void      (* pfn) (uintptr_t);
+    uintptr_t    arg;
+    } hrtimer_t, * hrtimer_id;
+
+/* externs */
+
+extern int      hrtimer_init     (hrtimer_id timer, void (* pfn) (uintptr_t),
+                                  uintptr_t arg);
+extern int      hrtimer_start    (hrtimer_id timer, uint32_t us);
+extern int      hrtimer_start_at (hrtimer_id timer, uint64_t cycles);
+extern int      hrtimer_cancel   (hrtimer_id timer);
+extern uint64_t hrtimer_us2cycles (uint32_t us);
+extern int      hrtimer_wait     (int (* job) (uintptr_t, uintptr_t),
+                                  uintptr_t arg, uint32_t us,
+                                  void (* on_timeout) (task_id));
+
+#endif  /* __HRTIMER_H__ */
@@ -0,0 +1,82 @@
+/* ipc.h - synchronous ipc library header file */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+#ifndef __IPC_H__
+#define __IPC_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <wheel/list.h>
+
+#include <kernel/task.h>
+
+/* typedefs */
+
+typedef struct ipc_ep
+    {
+    dlist_t   servers;      /* server tasks pending in ipc_receive, fifo */
+    pwait_q_t callers;      /* client tasks pending in ipc_call */
+    } ipc_ep_t, * ipc_ep_id;
+
+/* a call in progress, on the stack of the client */
+
+struct ipc_call
+    {
+    dlist_t      node;      /* linked in server->ipc_served */
+    ipc_ep_id    ep;
+    task_id      client;
+    task_id      server;    /* the server received this call, or NULL */
+    const void * req;
+    size_t       req_size;
+    void       * rsp;
+    size_t       rsp_size;
+    unsigned int slices;    /* tick slices of the server before received */
+    dlist_t      reply_q;   /* the client pending for reply */
+    };
+
+/* a receiving in progress, on the stack of the server */
+
+struct ipc_recv
+    {
+    ipc_ep_id         ep;
+    void            * buff;
+    size_t            size;
+    struct ipc_call * call; /* the call received */
+    };
+
+typedef struct ipc_call * ipc_client_id;
+
+/* defines */
+
+#define IPC_EP_INIT(name)       \
+    { DLIST_INIT ((name).servers), PWAIT_Q_INIT ((name).callers) }
+
+/* externs */
+
+extern int  ipc_ep_init      (ipc_ep_id ep);
+extern int  ipc_call         (ipc_ep_id ep, const void * req, size_t req_size,
+                              void * rsp, size_t rsp_size);
+extern int  ipc_timedcall    (ipc_ep_id ep, const void * req, size_t req_size,
+                              void * rsp, size_t rsp_size, unsigned int timeout);
+extern int  ipc_receive      (ipc_ep_id ep, void * buff, size_t size,
+                              ipc_client_id * client);
+extern int  ipc_timedreceive (ipc_ep_id ep, void * buff, size_t size,
+                              ipc_client_id * client, unsigned int timeout);
+extern int  ipc_reply        (ipc_client_id client, const void * buff,
+                              size_t size);
+
+extern void ipc_prio_inherit (struct ipc_call * call, uint8_t prio);
+extern void ipc_prio_restore (struct ipc_call * call);
+extern void ipc_task_cleanup (task_id task);
+
+#endif  /* __IPC_H__ */
@@ -0,0 +1,165 @@
+/* kbatch.h - kernel operation batch header file */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+collect several kernel operations and then do them with do_critical_batch, they
+will be done under one critical entry with only one reschedule, for example, in
+an isr:
+
+    kbatch_t batch = KBATCH_INIT;
+
+    kbatch_sem_post (&batch, &rx_sem);
+    kbatch_sem_post (&batch, &tx_sem);
+    kbatch_event_send (&batch, &dev_event, DEV_EVENT_ERR);
+
+    do_critical_batch (&batch);
+*/
+
+#ifndef __KBATCH_H__
+#define __KBATCH_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <kernel/critical.h>
+#include <kernel/task.h>
+#include <kernel/sem.h>
+#include <kernel/event.h>
+#include <kernel/timer.h>
+
+/* defines */
+
+#define KBATCH_INIT             { 0 }
+
+/* externs */
+
+extern int __sem_post     (uintptr_t arg1, uintptr_t arg2);
+extern int __event_send   (uintptr_t arg1, uintptr_t arg2);
+extern int __task_resume  (uintptr_t arg1, uintptr_t arg2);
+extern int __timer_start  (uintptr_t arg1, uintptr_t arg2);
+
+/* inlines */
+
+/**
+ * kbatch_init - initialize (or reset) a kernel operation batch
+ * @batch: the batch
+ *
+ * return: NA
+ */
+
+static inline void kbatch_init (kbatch_t * batch)
+    {
+    batch->nr = 0;
+    }
+
+/**
+ * kbatch_add - add a critical job to a kernel operation batch
+ * @batch: the batch
+ * @job:   the job routine
+ * @arg1:  the first argument
+ * @arg2:  the second argument
+ *
+ * return: 0 on success, negtive value if the batch is full
+ */
+
+static inline int kbatch_add (kbatch_t * batch, int (* job) (uintptr_t, uintptr_t),
+                              uintptr_t arg1, uintptr_t arg2)
+    {
+    if (batch->nr == KBATCH_MAX_JOBS)
+        {
+        return -1;
+        }
+
+    batch->jobs [batch->nr].pfn  = job;
+    batch->jobs [batch->nr].arg1 = arg1;
+    batch->jobs [batch->nr].arg2 = arg2;
+
+    batch->nr++;
+
+    return 0;
+    }
+
+/**
+ * kbatch_sem_post - add a sem_post to a kernel operation batch
+ * @batch: the batch
+ * @sem:   the semaphore to post
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+static inline int kbatch_sem_post (kbatch_t * batch, sem_id sem)
+    {
+    if (sem == NULL)
+        {
+        return -1;
+        }
+
+    return kbatch_add (batch, __sem_post, (uintptr_t) sem, 0);
+    }
+
+/**
+ * kbatch_event_send - add an event_send to a kernel operation batch
+ * @batch:  the batch
+ * @event:  the event id
+ * @events: event set
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+static inline int kbatch_event_send (kbatch_t * batch, event_id event,
+                                     uint32_t events)
+    {
+    if ((event == NULL) || (events == 0))
+        {
+        return -1;
+        }
+
+    return kbatch_add (batch, __event_send, (uintptr_t) event, (uintptr_t) events);
+    }
+
+/**
+ * kbatch_task_resume - add a task_resume to a kernel operation batch
+ * @batch: the batch
+ * @task:  the task to resume
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+static inline int kbatch_task_resume (kbatch_t * batch, task_id task)
+    {
+    if (task == NULL)
+        {
+        return -1;
+        }
+
+    return kbatch_add (batch, __task_resume, (uintptr_t) task, 0);
+    }
+
+/**
+ * kbatch_timer_start - add a timer_start to a kernel operation batch
+ * @batch: the batch
+ * @timer: the timer to start
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+static inline int kbatch_timer_start (kbatch_t * batch, timer_id timer)
+    {
+    if (timer == NULL)
+        {
+        return -1;
+        }
+
+    return kbatch_add (batch, __timer_start, (uintptr_t) timer, 0);
+    }
+
+#endif  /* __KBATCH_H__ */
@@ -23,17 +23,17 @@ modification history
 
 typedef struct mutex
     {
-    uint16_t recurse;
-    uint8_t  prio;      /* the max prio of the tasks pend on this mutex */
-    task_t * owner;
-    dlist_t  pend_q;
-    dlist_t  node;      /* linked in task_t->owned_mutex */
+    uint16_t  recurse;
+    uint8_t   prio;     /* the max prio of the tasks pend on this mutex */
+    task_t  * owner;
+    pwait_q_t pend_q;
+    dlist_t   node;     /* linked in task_t->owned_mutex */
     } mutex_t, * mutex_id;
 
 /* defines */
 
 #define MUTEX_INIT(name)        \
-    { 0, 0, NULL, { &(name).pend_q, &(name).pend_q }, { NULL, NULL } }
+    { 0, 0, NULL, PWAIT_Q_INIT ((name).pend_q), { NULL, NULL } }
 
 /* externs */
 
@@ -42,7 +42,13 @@ extern int mutex_lock      (mutex_id mutex);
 extern int mutex_lock      (mutex_id mutex);
 extern int mutex_trylock   (mutex_id mutex);
 extern int mutex_timedlock (mutex_id mutex, unsigned int timeout);
+extern int mutex_hrtimedlock (mutex_id mutex, uint32_t us);
 extern int mutex_unlock    (mutex_id mutex);
 
+extern void mutex_lock_for    (mutex_id mutex, task_id task);
+extern void mutex_relock_for  (mutex_id mutex, task_id task);
+extern void task_prio_inherit (task_id task, uint8_t prio);
+extern void task_prio_restore (task_id task);
+
 #endif /* __MUTEX_H__ */
 
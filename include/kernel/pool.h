@@ -0,0 +1,88 @@
+/* pool.h - fixed-size memory block pool library header file */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <wheel/common.h>
+
+#include <kernel/sem.h>
+
+/* defines */
+
+#define POOL_ALIGN              8
+#define POOL_FLAG_MALLOC        1
+
+#define POOL_BLK_SIZE(size)                                                 \
+    round_up ((size) < sizeof (void *) ? sizeof (void *) : (size), POOL_ALIGN)
+
+/* typedefs */
+
+typedef struct pool
+    {
+    sem_t        sem;           /* counts the free blocks */
+    void       * free;          /* blocks freed, linked by the first word */
+    char       * fresh;         /* blocks never allocated start from here */
+    char       * start;
+    char       * end;
+    size_t       blk_size;
+    size_t       nr_blks;
+    unsigned int flags;
+    } pool_t, * pool_id;
+
+/*
+ * the blocks never allocated are carved from <fresh>, so a pool needs no
+ * initialization at run time, it can be defined statically with POOL_DEF
+ */
+
+#define POOL_INIT(name, buff, size, nr)                                     \
+    {                                                                       \
+    SEM_INIT ((name).sem, nr), NULL, (char *) (buff), (char *) (buff),      \
+    (char *) (buff) + POOL_BLK_SIZE (size) * (nr), POOL_BLK_SIZE (size),   \
+    nr, 0                                                                   \
+    }
+
+#define POOL_DEF(name, size, nr)                                            \
+    static uint64_t name##_blks                                             \
+        [POOL_BLK_SIZE (size) / sizeof (uint64_t) * (nr)];                  \
+    static pool_t   name = POOL_INIT (name, name##_blks, size, nr)
+
+/* inlines */
+
+/**
+ * pool_owns - check if a memory block belongs to a pool
+ * @pool: the pool
+ * @blk:  the memory block
+ *
+ * return: true if the block is in the pool, false if not
+ */
+
+static inline bool pool_owns (pool_id pool, void * blk)
+    {
+    return ((char *) blk >= pool->start) && ((char *) blk < pool->end);
+    }
+
+/* externs */
+
+extern int     pool_init       (pool_id pool, void * buff, size_t blk_size,
+                                size_t nr_blks);
+extern pool_id pool_create     (size_t blk_size, size_t nr_blks);
+extern int     pool_delete     (pool_id pool);
+extern void  * pool_alloc      (pool_id pool);
+extern void  * pool_timedalloc (pool_id pool, unsigned int timeout);
+extern int     pool_free       (pool_id pool, void * blk);
+
+#endif  /* __POOL_H__ */
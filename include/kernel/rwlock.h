@@ -0,0 +1,61 @@
+/* rwlock.h - reader-writer lock library header file */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+#ifndef __RWLOCK_H__
+#define __RWLOCK_H__
+
+#include <stdint.h>
+
+#include <wheel/list.h>
+
+#include <kernel/task.h>
+
+/* defines */
+
+#define RWLOCK_PREFER_WRITER    0   /* new readers wait if any writer waiting */
+#define RWLOCK_PREFER_READER    1   /* new readers only wait for the holding writer */
+
+#define RWLOCK_MODE_READ        0
+#define RWLOCK_MODE_WRITE       1
+
+/* typedefs */
+
+typedef struct rwlock
+    {
+    uint16_t  readers;      /* number of tasks holding for read */
+    uint8_t   prio;         /* the max prio of the tasks pend on this rwlock */
+    uint8_t   option;
+    uint16_t  nr_wwaiters;  /* number of writers pending */
+    task_t  * writer;
+    dlist_t   holders;      /* struct rw_hold of all the holders */
+    pwait_q_t pend_q;
+    } rwlock_t;
+
+#define RWLOCK_INIT(name, option)                                           \
+    { 0, TASK_PRIO_MAX, option, 0, NULL,                                    \
+      DLIST_INIT ((name).holders), PWAIT_Q_INIT ((name).pend_q) }
+
+/* externs */
+
+extern int  rwlock_init        (rwlock_id rwlock, uint8_t option);
+extern int  rwlock_rdlock      (rwlock_id rwlock);
+extern int  rwlock_tryrdlock   (rwlock_id rwlock);
+extern int  rwlock_timedrdlock (rwlock_id rwlock, unsigned int timeout);
+extern int  rwlock_wrlock      (rwlock_id rwlock);
+extern int  rwlock_trywrlock   (rwlock_id rwlock);
+extern int  rwlock_timedwrlock (rwlock_id rwlock, unsigned int timeout);
+extern int  rwlock_unlock      (rwlock_id rwlock);
+
+extern void rwlock_prio_inherit (rwlock_id rwlock, uint8_t prio);
+extern void rwlock_prio_restore (rwlock_id rwlock);
+
+#endif  /* __RWLOCK_H__ */
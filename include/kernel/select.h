@@ -0,0 +1,115 @@
+/* select.h - kernel object multiple waiting library header file */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+#ifndef __SELECT_H__
+#define __SELECT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <wheel/list.h>
+
+#include <kernel/task.h>
+#include <kernel/sem.h>
+#include <kernel/event.h>
+#include <kernel/msg_queue.h>
+#include <kernel/timer.h>
+
+/* defines */
+
+#define KOBJ_SEL_SEM            0
+#define KOBJ_SEL_EVENT          1
+#define KOBJ_SEL_TIMER          2
+
+/* typedefs */
+
+typedef struct kobj_sel
+    {
+    dlist_t      node;          /* linked in the sel_q of the object */
+    uint8_t      type;
+    bool         ready;         /* set by kobj_select if the object is ready */
+    void       * obj;
+    uint32_t     wanted;        /* for KOBJ_SEL_EVENT only */
+    uint32_t     option;        /* for KOBJ_SEL_EVENT only */
+    task_id      task;          /* the selecting task */
+    } kobj_sel_t;
+
+/* inlines */
+
+/**
+ * kobj_sel_sem - setup a select entry for a semaphore
+ * @sel: the select entry
+ * @sem: the semaphore, ready when it can be taken without blocking
+ *
+ * return: NA
+ */
+
+static inline void kobj_sel_sem (kobj_sel_t * sel, sem_id sem)
+    {
+    sel->type = KOBJ_SEL_SEM;
+    sel->obj  = sem;
+    }
+
+/**
+ * kobj_sel_mq - setup a select entry for a message queue
+ * @sel: the select entry
+ * @mq:  the message queue
+ * @op:  MQ_OP_RD wait for a message to receive, MQ_OP_WT wait for a free slot
+ *
+ * return: NA
+ */
+
+static inline void kobj_sel_mq (kobj_sel_t * sel, mq_id mq, unsigned int op)
+    {
+    kobj_sel_sem (sel, &mq->sem [op]);
+    }
+
+/**
+ * kobj_sel_event - setup a select entry for an event
+ * @sel:    the select entry
+ * @event:  the event
+ * @wanted: wanted event set
+ * @option: EVENT_WAIT_ALL or EVENT_WAIT_ANY
+ *
+ * return: NA
+ */
+
+static inline void kobj_sel_event (kobj_sel_t * sel, event_id event,
+                                   uint32_t wanted, uint32_t option)
+    {
+    sel->type   = KOBJ_SEL_EVENT;
+    sel->obj    = event;
+    sel->wanted = wanted;
+    sel->option = option;
+    }
+
+/**
+ * kobj_sel_timer - setup a select entry for a timer
+ * @sel:   the select entry
+ * @timer: the timer, ready when it expired since it is reported last time
+ *
+ * return: NA
+ */
+
+static inline void kobj_sel_timer (kobj_sel_t * sel, timer_id timer)
+    {
+    sel->type = KOBJ_SEL_TIMER;
+    sel->obj  = timer;
+    }
+
+/* externs */
+
+extern int  kobj_select     (kobj_sel_t * sels, unsigned int nr,
+                             unsigned int timeout);
+extern void kobj_sel_notify (dlist_t * sel_q);
+
+#endif  /* __SELECT_H__ */
@@ -21,17 +21,20 @@ typedef struct sem
     {
     unsigned int count;
     dlist_t      pend_q;
+    dlist_t      sel_q;
     } sem_t, * sem_id;
 
 /* defines */
 
 #define SEM_INIT(name, count)       \
-    { count, { &(name).pend_q, &(name).pend_q } }
+    { count, { &(name).pend_q, &(name).pend_q },        \
+      { &(name).sel_q, &(name).sel_q } }
 
 extern int sem_init      (sem_t * sem, uintptr_t value);
 extern int sem_wait      (sem_t * sem);
 extern int sem_trywait   (sem_t * sem);
 extern int sem_timedwait (sem_t * sem, unsigned int timeout);
+extern int sem_hrtimedwait (sem_t * sem, uint32_t us);
 extern int sem_post      (sem_t * sem);
 
 #endif  /* __SEM_H__ */
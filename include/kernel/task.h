@@ -15,7 +15,9 @@ modification history
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
+#include <wheel/common.h>
 #include <wheel/list.h>
 
 #include <kernel/tick.h>
@@ -40,7 +42,35 @@ modification history
 
 #define TASK_SECTION_NAME       static_task
 
-typedef struct mutex * mutex_id;
+#define TASK_NR_RW_HOLDS        2   /* max rwlocks can be held by a task */
+
+typedef struct mutex  * mutex_id;
+typedef struct rwlock * rwlock_id;
+
+/* a rwlock held by a task, for read or write */
+
+struct rw_hold
+    {
+    dlist_t                node;        /* linked in rwlock->holders */
+    rwlock_id              rwlock;      /* NULL if this slot is free */
+    struct task          * task;
+    uint16_t               recurse;
+    };
+
+/*
+ * priority wait queue, all the waiting tasks are linked in <tasks> ordered by
+ * priority (fifo for the same priority), <tails> records the last task of each
+ * priority set in <bmap>, so insert, remove and re-prioritize are all O(1)
+ */
+
+typedef struct pwait_q
+    {
+    uint32_t               bmap;
+    dlist_t                tasks;
+    dlist_t              * tails [NR_TASK_PRIOS];
+    } pwait_q_t;
+
+#define PWAIT_Q_INIT(name)      { 0, DLIST_INIT ((name).tasks), { NULL } }
 
 typedef struct task
     {
@@ -56,6 +86,7 @@ typedef struct task
     uint8_t                o_prio;
 
     unsigned int           tick_slices;
+    unsigned int           tick_slack;  /* slack ticks for the timed waits */
 
     int                 (* entry) (uintptr_t);
     uintptr_t              arg;
@@ -69,11 +100,29 @@ typedef struct task
         };
 
     dlist_t                pq_node;
+    pwait_q_t            * pwait_q;     /* the priority wait queue pending in */
+    uint8_t                pq_prio;     /* the priority when added to pwait_q */
 
     /* ipc related feilds */
 
     dlist_t                mutex_owned;
     mutex_id               mutex_wanted;
+    mutex_id               cond_mutex;  /* relocked if a cond wait timeout */
+
+    struct rw_hold         rw_holds [TASK_NR_RW_HOLDS];
+    rwlock_id              rwlock_wanted;
+    uint8_t                rwlock_mode;
+
+    dlist_t                ipc_served;  /* ipc calls received not replied */
+    struct ipc_call      * ipc_call;    /* the ipc call this task is making */
+    struct ipc_recv      * ipc_recv;    /* the ipc receiving this task doing */
+
+    /* release statistics of a periodic task, see task_delay_until */
+
+    uint32_t               releases;
+    uint32_t               overruns;    /* releases later than the deadline */
+    uint32_t               jitter_last; /* in system clock cycles */
+    uint32_t               jitter_max;
 
 #if 1   // TODO: ifdef RTW_CONFIG_EVENT
     uint32_t               event_wanted;
@@ -120,6 +169,7 @@ static task_t __static_task_##n##_tcb _RTW_SECTION (TASK_SECTION_NAME) =    \
     .entry       = (int (*) (uintptr_t)) e,                                 \
     .arg         = a,                                                       \
     .mutex_owned = DLIST_INIT (__static_task_##n##_tcb.mutex_owned),        \
+    .ipc_served  = DLIST_INIT (__static_task_##n##_tcb.ipc_served),         \
     .name        = __CVTSTR (n),                                            \
     };                                                                      \
                                                                             \
@@ -149,8 +199,11 @@ extern task_id        task_spawn        (const char * name, uint8_t prio,
                                          int (* entry) (uintptr_t),
                                          uintptr_t arg);
 extern uint8_t        task_prio_get     (task_id task);
+extern int            task_slack_set    (task_id task, unsigned int slack);
 extern void           task_entry        (task_id task);
 extern int            task_delay        (unsigned int ticks);
+extern int            task_delay_until  (uint64_t * last_wake,
+                                         unsigned int period);
 extern void           task_lock         (void);
 extern void           task_unlock       (void);
 extern void           task_retval_set   (struct task * task, int retval);
@@ -165,8 +218,44 @@ extern void           task_ready_q_ins  (struct task * task);
 extern void           task_ready_q_del  (struct task * task);
 extern void           task_fwait_q_add  (dlist_t * q, unsigned int timeout,
                                          void (* callback) (task_id task));
-extern void           task_pwait_q_add  (dlist_t * q, unsigned int timeout,
+extern void           task_pwait_q_add  (pwait_q_t * q, unsigned int timeout,
                                          void (* callback) (task_id task));
-extern void           task_pwait_q_adj  (dlist_t * q, task_id task);
+extern void           task_pwait_q_adj  (pwait_q_t * q, task_id task);
+extern void           task_pwait_q_move (pwait_q_t * q, task_id task);
+extern void           task_pwait_q_pend (pwait_q_t * q, task_id task);
+extern void           task_fwait_q_move (dlist_t * q, task_id task);
+extern void           pwait_q_init      (pwait_q_t * q);
+
+/* inlines */
+
+/**
+ * pwait_q_empty - check if a priority wait queue is empty
+ * @q: the priority wait queue
+ *
+ * return: true if empty, false if not
+ */
+
+static inline bool pwait_q_empty (pwait_q_t * q)
+    {
+    return q->bmap == 0;
+    }
+
+/**
+ * pwait_q_first - get the highest priority task in a priority wait queue
+ * @q: the priority wait queue
+ *
+ * return: the first task or NULL if the queue is empty
+ */
+
+static inline task_id pwait_q_first (pwait_q_t * q)
+    {
+    if (q->bmap == 0)
+        {
+        return NULL;
+        }
+
+    return container_of (q->tasks.next, task_t, pq_node);
+    }
+
 #endif  /* __TASK_H__ */
 
@@ -27,10 +27,14 @@ struct tick_q_node
 
 extern void tick_q_del  (struct tick_q_node * node);
 extern void tick_q_add  (struct tick_q_node * node, unsigned int ticks,
+                         unsigned int slack,
                          void (*pfn) (struct tick_q_node *, uintptr_t),
                          uintptr_t arg);
 extern void tick_shot_n (unsigned int ticks);
 extern void tick_shot   (void);
 
+extern uint64_t tick_count_get (void);
+extern uint32_t tick_merged_get (void);
+
 #endif  /* __TICK_H__ */
 
@@ -30,14 +30,23 @@ typedef struct timer
     uint16_t           flag;
     struct tick_q_node tq_node;
     unsigned long      interval;
+    unsigned int       slack;       /* ticks the expiry may be delayed */
+    uint64_t           deadline;    /* absolute tick of the next expiry */
+    unsigned int       overruns;    /* periods skipped as already passed */
     void            (* pfn) (uintptr_t);
     uintptr_t          arg;
+    unsigned int       expired;     /* expirations not reported by select */
+    dlist_t            sel_q;
+    unsigned int       svc_pending; /* callbacks pending for the timer task */
+    dlist_t            svc_node;
     } timer_t, * timer_id;
 
 extern int timer_init        (timer_id timer, uint16_t mode, unsigned long interval,
-                              void (*pfn)(uintptr_t), uintptr_t arg);
+                              unsigned int slack, void (*pfn)(uintptr_t),
+                              uintptr_t arg);
 extern timer_id timer_create (uint16_t flag, unsigned long interval,
-                              void (*pfn) (uintptr_t), uintptr_t arg);
+                              unsigned int slack, void (*pfn) (uintptr_t),
+                              uintptr_t arg);
 extern int timer_start       (timer_id timer);
 extern int timer_stop        (timer_id timer);
 extern int timer_delete      (timer_id timer);
@@ -252,7 +252,10 @@ do {                                                    \
             l = w;                                      \
             }                                           \
                                                         \
-        w = c < 0 ? w->r : w->l;                        \
+        /* on equal, go right for '>', left for '<' */  \
+                                                        \
+        w = ((c < 0) || ((c == 0) && (1 cond 0))) ?     \
+            w->r : w->l;                                \
         }                                               \
                                                         \
     return l;                                           \
@@ -0,0 +1,52 @@
+/* arena.h - pointer bump arena allocator header file */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* typedefs */
+
+typedef struct arena
+    {
+    char             * base;
+    char             * cur;     /* the next free byte */
+    char             * end;
+    } arena_t;
+
+/* inlines */
+
+/**
+ * arena_owns - check if a memory block is allocated from an arena
+ * @arena: the arena
+ * @mem:   the memory block
+ *
+ * return: true if the memory is allocated from the arena, false if not
+ */
+
+static inline bool arena_owns (arena_t * arena, void * mem)
+    {
+    return ((char *) mem >= arena->base) && ((char *) mem < arena->cur);
+    }
+
+/* externs */
+
+extern int    arena_init        (arena_t * arena, char * buff, size_t size);
+extern char * arena_alloc_align (arena_t * arena, size_t align, size_t bytes);
+extern char * arena_alloc       (arena_t * arena, size_t bytes);
+extern void   arena_reset       (arena_t * arena);
+extern char * arena_mark        (arena_t * arena);
+extern int    arena_release     (arena_t * arena, char * mark);
+
+#endif  /* __ARENA_H__ */
@@ -20,7 +20,7 @@ modification history
 typedef struct avl_node
     {
     bi_node_t  bin;
-    int        height;
+    int        height;      /* 1 for leaves */
     } avl_node_t;
 
 typedef struct avl_tree
@@ -28,5 +28,27 @@ typedef struct avl_tree
     bi_tree_t  bit;
     } avl_tree_t;
 
+/* externs */
+
+extern int          avl_insert   (avl_tree_t * t, avl_node_t * n);
+extern void         avl_delete   (avl_tree_t * t, avl_node_t * n);
+extern void         avl_init     (avl_tree_t * t,
+                                  int (* compare_nn) (bi_node_t *, bi_node_t *),
+                                  int (* compare_nk) (bi_node_t *, uintptr_t));
+extern avl_node_t * avl_find_eq  (avl_tree_t * t, uintptr_t k);
+extern avl_node_t * avl_find_ge  (avl_tree_t * t, uintptr_t k);
+extern avl_node_t * avl_find_gt  (avl_tree_t * t, uintptr_t k);
+extern avl_node_t * avl_find_le  (avl_tree_t * t, uintptr_t k);
+extern avl_node_t * avl_find_lt  (avl_tree_t * t, uintptr_t k);
+extern avl_node_t * avl_first    (avl_tree_t * t);
+extern avl_node_t * avl_last     (avl_tree_t * t);
+extern avl_node_t * avl_next     (avl_node_t * n);
+extern avl_node_t * avl_prev     (avl_node_t * n);
+extern avl_node_t * avl_node_get (avl_tree_t * t, uintptr_t k,
+                                  bi_node_t * (* create) (uintptr_t, uintptr_t),
+                                  uintptr_t arg);
+extern void         avl_replace  (avl_tree_t * t, avl_node_t * o,
+                                  avl_node_t * n);
+
 #endif  /* __AVLTREE_H__ */
 
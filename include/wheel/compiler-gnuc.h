@@ -49,6 +49,12 @@ modification history
 
 #define __clz           __builtin_clz
 
+/*
+ * __ret_addr - the return address of the current function
+ */
+
+#define __ret_addr()    __builtin_return_address (0)
+
 /*
  * _RTW_SECTION - place a symbol in a specific section
  * @name: the section name.
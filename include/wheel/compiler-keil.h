@@ -49,6 +49,12 @@ modification history
 
 #undef  __clz
 
+/*
+ * __ret_addr - the return address of the current function
+ */
+
+#define __ret_addr()    ((void *) __return_address ())
+
 /*
  * _RTW_SECTION - place a symbol in a specific section
  * @name: the section name.
@@ -42,5 +42,11 @@ modification history
 
 #define __clz           __lzcnt
 
+/*
+ * __ret_addr - the return address of the current function
+ */
+
+#define __ret_addr()    _ReturnAddress ()
+
 #endif  /* __COMPILER_MSVC_H__ */
 
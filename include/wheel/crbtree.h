@@ -0,0 +1,313 @@
+/* crbtree.h - compact red black tree header file */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+a compact red black tree differs from rbtree.h in:
+
+1) the color is kept in bit 0 of the parent pointer, so a node is 3 pointers
+2) there are no compare function pointers, the searching and linking routines
+   are generated for each type with CRB_GENERATE, the key comparison is inlined
+3) the left most node is cached in the root, crb_first is O(1)
+4) optional augmented data, see crb_augment_t
+
+only the searching and linking is generated, the re-balancing is shared in
+utils/crbtree.c, so each type costs little more code.
+
+    struct foo
+        {
+        crb_node_t node;
+        uint32_t   key;
+        };
+
+    CRB_GENERATE (foo_tree, struct foo, node, uint32_t, key, CRB_CMP_NUM, NULL)
+
+generates foo_tree_insert, foo_tree_delete, foo_tree_find_eq, foo_tree_find_ge,
+foo_tree_find_gt, foo_tree_find_le, foo_tree_find_lt, foo_tree_first,
+foo_tree_last, foo_tree_next and foo_tree_prev, all static inline.
+*/
+
+#ifndef __CRBTREE_H__
+#define __CRBTREE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <wheel/common.h>
+
+/* defines */
+
+#define CRBTREE_RED             0
+#define CRBTREE_BLACK           1
+
+/* typedefs */
+
+typedef struct crb_node
+    {
+    uintptr_t          pc;      /* parent | color */
+    struct crb_node  * l;
+    struct crb_node  * r;
+    } crb_node_t;
+
+typedef struct crb_root
+    {
+    crb_node_t       * r;       /* root */
+    crb_node_t       * first;   /* the left most node, cached */
+    } crb_root_t;
+
+/*
+ * augmented data is kept in the user struct and is computed from the node and
+ * its children (like the max end of an interval tree, or the size of a sub
+ * tree), <update> recomputes it for a node whose children or children's data
+ * changed, and returns true if the data of the node changed
+ */
+
+typedef struct crb_augment
+    {
+    bool            (* update) (crb_node_t * n);
+    } crb_augment_t;
+
+#define CRB_ROOT_INIT           { NULL, NULL }
+
+/* compare two numeric keys, can be used as the <cmp> of CRB_GENERATE */
+
+#define CRB_CMP_NUM(a, b)       ((a) < (b) ? -1 : (a) > (b))
+
+/* inlines */
+
+/**
+ * crb_parent - get the parent of a node
+ * @n: the given node
+ *
+ * return: the parent, NULL for the root
+ */
+
+static inline crb_node_t * crb_parent (crb_node_t * n)
+    {
+    return (crb_node_t *) (n->pc & ~(uintptr_t) 1);
+    }
+
+/**
+ * crb_first - get the first (left most) node of a tree, O(1)
+ * @t: the given tree
+ *
+ * return: the first node, or NULL if the tree is empty
+ */
+
+static inline crb_node_t * crb_first (crb_root_t * t)
+    {
+    return t->first;
+    }
+
+/**
+ * crb_init - init a compact rb-tree
+ * @t: the given tree
+ *
+ * return: NA
+ */
+
+static inline void crb_init (crb_root_t * t)
+    {
+    t->r     = NULL;
+    t->first = NULL;
+    }
+
+/**
+ * crb_link - link a new red node to its place found by searching
+ * @n:    the new node
+ * @p:    the parent, NULL if the tree is empty
+ * @link: the child pointer of <p> (or the root) to link <n> to
+ *
+ * return: NA
+ */
+
+static inline void crb_link (crb_node_t * n, crb_node_t * p, crb_node_t ** link)
+    {
+    n->pc = (uintptr_t) p | CRBTREE_RED;
+    n->l  = NULL;
+    n->r  = NULL;
+
+    *link = n;
+    }
+
+/* externs */
+
+extern void         crb_insert_color (crb_root_t * t, crb_node_t * n,
+                                      const crb_augment_t * aug);
+extern void         crb_erase        (crb_root_t * t, crb_node_t * n,
+                                      const crb_augment_t * aug);
+extern void         crb_replace      (crb_root_t * t, crb_node_t * o,
+                                      crb_node_t * n);
+extern crb_node_t * crb_last         (crb_root_t * t);
+extern crb_node_t * crb_next         (crb_node_t * n);
+extern crb_node_t * crb_prev         (crb_node_t * n);
+
+/*
+ * __CRB_FIND_XX - generate a routine finding the nearest node with key greater
+ *                 or less than (or equal to) a given key
+ * @name:  the tree name
+ * @type:  the struct type containing the node
+ * @field: the member name of the node in <type>
+ * @ktype: the key type
+ * @key:   the member name of the key in <type>
+ * @cmp:   the key comparing macro or routine, see CRB_CMP_NUM
+ * @xx:    suffix of the routine, ge, gt, le or lt
+ * @cond:  the condition of the other nodes to remember, > 0 or < 0
+ * @eq:    what to do on an equal node, 0 to return it, 1 to go right (gt) or
+ *         -1 to go left (lt)
+ */
+
+#define __CRB_FIND_XX(name, type, field, ktype, key, cmp, xx, cond, eq)     \
+static inline type * name##_find_##xx (crb_root_t * t, ktype k)             \
+    {                                                                       \
+    crb_node_t * w = t->r;                                                  \
+    type       * l = NULL;                                                  \
+                                                                            \
+    while (w != NULL)                                                       \
+        {                                                                   \
+        type * e = container_of (w, type, field);                           \
+        int    c = cmp (e->key, k);                                         \
+                                                                            \
+        if (c == 0)                                                         \
+            {                                                               \
+            if (eq == 0)                                                    \
+                {                                                           \
+                return e;                                                   \
+                }                                                           \
+                                                                            \
+            c = -eq;                                                        \
+            }                                                               \
+        else if (c cond)                                                    \
+            {                                                               \
+            l = e;                                                          \
+            }                                                               \
+                                                                            \
+        w = c < 0 ? w->r : w->l;                                            \
+        }                                                                   \
+                                                                            \
+    return l;                                                               \
+    }
+
+/*
+ * CRB_GENERATE - generate the routines of a compact rb-tree of a type
+ * @name:  the tree name, prefix of the routines
+ * @type:  the struct type containing the node
+ * @field: the member name of the node in <type>
+ * @ktype: the key type
+ * @key:   the member name of the key in <type>
+ * @cmp:   the key comparing macro or routine, cmp (a, b) returns negative,
+ *         zero or positive for a < b, a == b or a > b, see CRB_CMP_NUM
+ * @aug:   pointer to the crb_augment_t, or NULL if not augmented
+ *
+ * name##_insert returns NULL when inserted, or the node with the same key
+ * already in the tree (<n> not inserted)
+ */
+
+#define CRB_GENERATE(name, type, field, ktype, key, cmp, aug)               \
+                                                                            \
+static inline type * name##_entry (crb_node_t * n)                          \
+    {                                                                       \
+    return n == NULL ? NULL : container_of (n, type, field);                \
+    }                                                                       \
+                                                                            \
+static inline type * name##_insert (crb_root_t * t, type * n)               \
+    {                                                                       \
+    crb_node_t ** link     = &t->r;                                         \
+    crb_node_t  * p        = NULL;                                          \
+    bool          leftmost = true;                                          \
+                                                                            \
+    while (*link != NULL)                                                   \
+        {                                                                   \
+        int c;                                                              \
+                                                                            \
+        p = *link;                                                          \
+        c = cmp (n->key, container_of (p, type, field)->key);               \
+                                                                            \
+        if (c == 0)                                                         \
+            {                                                               \
+            return container_of (p, type, field);                           \
+            }                                                               \
+                                                                            \
+        if (c < 0)                                                          \
+            {                                                               \
+            link = &p->l;                                                   \
+            }                                                               \
+        else                                                                \
+            {                                                               \
+            link     = &p->r;                                               \
+            leftmost = false;                                               \
+            }                                                               \
+        }                                                                   \
+                                                                            \
+    crb_link (&n->field, p, link);                                          \
+                                                                            \
+    if (leftmost)                                                           \
+        {                                                                   \
+        t->first = &n->field;                                               \
+        }                                                                   \
+                                                                            \
+    crb_insert_color (t, &n->field, aug);                                   \
+                                                                            \
+    return NULL;                                                            \
+    }                                                                       \
+                                                                            \
+static inline void name##_delete (crb_root_t * t, type * n)                 \
+    {                                                                       \
+    crb_erase (t, &n->field, aug);                                          \
+    }                                                                       \
+                                                                            \
+static inline type * name##_find_eq (crb_root_t * t, ktype k)               \
+    {                                                                       \
+    crb_node_t * w = t->r;                                                  \
+                                                                            \
+    while (w != NULL)                                                       \
+        {                                                                   \
+        type * e = container_of (w, type, field);                           \
+        int    c = cmp (e->key, k);                                         \
+                                                                            \
+        if (c == 0)                                                         \
+            {                                                               \
+            return e;                                                       \
+            }                                                               \
+                                                                            \
+        w = c < 0 ? w->r : w->l;                                            \
+        }                                                                   \
+                                                                            \
+    return NULL;                                                            \
+    }                                                                       \
+                                                                            \
+__CRB_FIND_XX (name, type, field, ktype, key, cmp, ge, > 0,  0)             \
+__CRB_FIND_XX (name, type, field, ktype, key, cmp, gt, > 0,  1)             \
+__CRB_FIND_XX (name, type, field, ktype, key, cmp, le, < 0,  0)             \
+__CRB_FIND_XX (name, type, field, ktype, key, cmp, lt, < 0, -1)             \
+                                                                            \
+static inline type * name##_first (crb_root_t * t)                          \
+    {                                                                       \
+    return name##_entry (crb_first (t));                                    \
+    }                                                                       \
+                                                                            \
+static inline type * name##_last (crb_root_t * t)                           \
+    {                                                                       \
+    return name##_entry (crb_last (t));                                     \
+    }                                                                       \
+                                                                            \
+static inline type * name##_next (type * n)                                 \
+    {                                                                       \
+    return name##_entry (crb_next (&n->field));                             \
+    }                                                                       \
+                                                                            \
+static inline type * name##_prev (type * n)                                 \
+    {                                                                       \
+    return name##_entry (crb_prev (&n->field));                             \
+    }
+
+#endif  /* __CRBTREE_H__ */
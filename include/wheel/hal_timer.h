@@ -36,8 +36,22 @@ typedef struct hal_timer_methods
     int          (* connect) (hal_timer_t * timer, void (* pfn) (uintptr_t),
                               uintptr_t arg);
     uint64_t     (* counter) (hal_timer_t * timer);
+
+    /* optional, for the spare one-shot compare channels */
+
+    int          (* chan_enable)  (hal_timer_t * timer, uint8_t chan,
+                                   uint64_t cmp);
+    int          (* chan_disable) (hal_timer_t * timer, uint8_t chan);
     } hal_timer_methods_t;
 
+/* a spare compare channel, fire once when the counter reach the compare value */
+
+typedef struct hal_timer_chan
+    {
+    void         (* handler) (uintptr_t);
+    uintptr_t    arg;
+    } hal_timer_chan_t;
+
 struct hal_timer
     {
     dlist_t      node;              /* node to be inserted in the timer list */
@@ -46,11 +60,14 @@ struct hal_timer
     uint8_t      mode;
     bool         busy;              /* timer allocated */
     bool         down;              /* timer counting down */
+    bool         free_run;          /* counter not reset at every period */
     uint32_t     freq;
     uint64_t     cmp_rld;           /* compare value or reload value */
     uint64_t     max_count;
     void         (* handler) (uintptr_t);
     uintptr_t    arg;
+    uint8_t      nr_chans;          /* number of spare compare channels */
+    hal_timer_chan_t * chans;
 
     const hal_timer_methods_t * methods;
     };
@@ -63,6 +80,12 @@ extern int           hal_timer_connect  (hal_timer_t * timer,
                                          void (* pfn) (uintptr_t),
                                          uintptr_t arg);
 extern uint64_t      hal_timer_counter  (hal_timer_t * timer);
+extern int           hal_timer_chan_enable  (hal_timer_t * timer, uint8_t chan,
+                                             uint64_t cmp);
+extern int           hal_timer_chan_disable (hal_timer_t * timer, uint8_t chan);
+extern int           hal_timer_chan_connect (hal_timer_t * timer, uint8_t chan,
+                                             void (* pfn) (uintptr_t),
+                                             uintptr_t arg);
 extern int           hal_timer_register (hal_timer_t * timer);
 extern hal_timer_t * hal_timer_get      (const char * name, uint8_t mode);
 
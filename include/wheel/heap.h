@@ -18,8 +18,9 @@ modification history
 #include <arch/config.h>
 
 #include <wheel/common.h>
-#include <wheel/rbtree.h>
+#include <wheel/crbtree.h>
 #include <wheel/list.h>
+#include <wheel/tlsf.h>
 
 #include <kernel/mutex.h>
 
@@ -29,6 +30,25 @@ modification history
 
 #define ALLOC_ALIGN_MASK        (ALLOC_ALIGN - 1)
 
+/* the way to index the free chunks */
+
+#define HEAP_TYPE_RBTREE        0   /* best fit, O(1) small, O(log n) big */
+#define HEAP_TYPE_TLSF          1   /* good fit, O(1), see tlsf.h */
+
+/* number of the per-size block caches for isr allocating, see heap_isr_alloc */
+
+#ifndef HEAP_NR_ISR_CACHES
+#define HEAP_NR_ISR_CACHES      4
+#endif
+
+/* free chunks not bigger than this (chunk head excluded) are kept in lists */
+
+#ifndef HEAP_SMALL_MAX
+#define HEAP_SMALL_MAX          256
+#endif
+
+#define HEAP_NR_SMALLS          (HEAP_SMALL_MAX / ALLOC_ALIGN)
+
 #define MIN_HEAP_SIZE           (round_up (sizeof (block_t), ALLOC_ALIGN) + \
                                  sizeof (struct chunk) * 3 + ALLOC_ALIGN)
 
@@ -39,10 +59,12 @@ STATIC_ASSERT ((ALLOC_ALIGN != 0));
 STATIC_ASSERT ((ALLOC_ALIGN & (sizeof (void *) - 1)) == 0);
 STATIC_ASSERT ((ALLOC_ALIGN & ALLOC_ALIGN_MASK) == 0);
 STATIC_ASSERT (sizeof (uintptr_t) <= ALLOC_ALIGN);
+STATIC_ASSERT ((HEAP_SMALL_MAX & ALLOC_ALIGN_MASK) == 0);
+STATIC_ASSERT ((HEAP_NR_SMALLS > 0) && (HEAP_NR_SMALLS <= 32));
 
 typedef struct size_node
     {
-    rb_node_t          node;    /* 3 x ptr + 1 x int */
+    crb_node_t         node;    /* 3 x ptr */
     size_t             size;    /* 1 x long */
     dlist_t            list;    /* 2 x ptr */
     } size_node_t;
@@ -72,6 +94,72 @@ typedef struct block
     chunk_t          * chunk_head;
     } block_t;
 
+/*
+ * blocks of <size> allocated in task context and kept for heap_isr_alloc, they
+ * are linked by the first word, the list is refilled to <target> blocks in the
+ * next task context heap operation
+ */
+
+struct heap_isr_cache
+    {
+    size_t             size;    /* 0 if the cache is not used */
+    unsigned int       nr;
+    unsigned int       target;
+    void             * list;
+    };
+
+/* information got by walking all the chunks of a heap, see heap_frag_get */
+
+#define HEAP_FRAG_BUCKETS       12
+
+struct heap_frag
+    {
+    unsigned int       free_chunks;
+    size_t             free_size;
+    size_t             max_free;    /* the largest free chunk */
+    unsigned int       busy_chunks;
+    size_t             busy_size;
+    unsigned int       frag;        /* 100 - max_free * 100 / free_size */
+
+    /*
+     * number of free chunks with size in [2 ^ (n + 4), 2 ^ (n + 5)), the
+     * chunks under 16 bytes are counted in hist [0], and the ones of 2 ^ 15
+     * bytes or more in the last
+     */
+
+    unsigned int       hist [HEAP_FRAG_BUCKETS];
+    };
+
+/*
+ * with HEAP_TRACE defined, every heap_alloc*, heap_free and heap_realloc is
+ * recorded in heap_trace_ring with the return address of the caller, the
+ * "memtrace" command dumps the ring, to be symbolized by tools/heap_trace.py
+ */
+
+#ifdef HEAP_TRACE
+
+#ifndef HEAP_TRACE_RECS
+#define HEAP_TRACE_RECS         64
+#endif
+
+#define HEAP_TRACE_ALLOC        0
+#define HEAP_TRACE_FREE         1
+#define HEAP_TRACE_REALLOC      2   /* the old block is in the FREE record before */
+
+struct heap_trace_rec
+    {
+    uint32_t           time;    /* low 32 bits of the system clock cycles */
+    uint32_t           size_op; /* size << 2 | op */
+    uintptr_t          caller;
+    uintptr_t          mem;
+    uintptr_t          task;
+    };
+
+extern struct heap_trace_rec heap_trace_ring [HEAP_TRACE_RECS];
+extern uint32_t              heap_trace_seq;    /* number of records ever */
+
+#endif
+
 #ifdef INCLUDE_MEM_STATISTICS
 struct mem_stat
     {
@@ -89,57 +177,40 @@ struct mem_stat
 
 struct heap
     {
-    rb_tree_t          sizes;
     dlist_t            blocks;
     mutex_t            mux;
+    uint8_t            type;
 
-    /*
-     * only when chunk->size < (sizeof (chunk_t) + sizeof (size_node_t))
-     * size_nodes[n] will be used. And:
-     *
-     * 1) chunk->size is n * ALLOC_ALIGN
-     * 2) chunks with chunk->size == sizeof (chunk_t) will not be inserted
-     *
-     * so size_nodes[0] for chunk->size = sizeof (chunk_t) + ALLOC_ALIGN
-     *    size_nodes[1] for chunk->size = sizeof (chunk_t) + ALLOC_ALIGN * 2
-     *    ...
-     *
-     * so the index in this array should be:
-     *
-     *    idx = (chunk->size - sizeof (chunk_t)) / ALLOC_ALIGN - 1;
-     *
-     * as chunks with chunk->size >= sizeof (chunk_t) + sizeof (size_node_t)
-     * will not use this array, the max chunk size use this array be:
-     *
-     *    max_size = sizeof (chunk_t) + sizeof (size_node_t) - ALLOC_ALIGN;
-     *
-     * and so the max index it uses is:
-     *
-     *    max = (max_size - sizeof (chunk_t)) / ALLOC_ALIGN - 1;
-     *
-     * ==>
-     *
-     *    max = (sizeof (chunk_t) + sizeof (size_node_t) - ALLOC_ALIGN - sizeof (chunk_t)) / ALLOC_ALIGN - 1;
-     *
-     * ==>
-     *
-     *    max = (sizeof (size_node_t) - ALLOC_ALIGN) / ALLOC_ALIGN - 1;
-     *
-     * as the idx is [0 ~ (sizeof (size_node_t) - ALLOC_ALIGN) / ALLOC_ALIGN - 1],
-     * the elements of this array is:
-     *
-     *    elements = (sizeof (size_node_t) - ALLOC_ALIGN) / ALLOC_ALIGN;
-     *
-     * which is equal to
-     *
-     *    elements = (sizeof (size_node_t) - 1) / ALLOC_ALIGN;
-     */
+    union
+        {
+        tlsf_t       * tlsf;    /* for HEAP_TYPE_TLSF, in the first block */
 
-    size_node_t        size_nodes [(sizeof (size_node_t) - 1) / ALLOC_ALIGN];
+        struct                  /* for HEAP_TYPE_RBTREE */
+            {
 
-#ifdef HEAP_DEBUG
-    size_node_t        sn_guard [2];
-#endif
+            /*
+             * free chunks with size up to sizeof (chunk_t) + HEAP_SMALL_MAX
+             * are kept in exact-fit lists:
+             *
+             *    idx = (chunk->size - sizeof (chunk_t)) / ALLOC_ALIGN - 1;
+             *
+             * bit <idx> of small_map is set if smalls [idx] is not empty, so
+             * the best fit small chunk is found with one __ffs. only bigger
+             * chunks go to the rbtree, they are always big enough to hold the
+             * size_node_t in their own memory block.
+             */
+
+            uint32_t   small_map;
+            dlist_t    smalls [HEAP_NR_SMALLS];
+            crb_root_t sizes;
+            };
+        };
+
+    /* memory freed when the mutex can not be taken, linked by the first word */
+
+    void * volatile    deferred;
+
+    struct heap_isr_cache isr_caches [HEAP_NR_ISR_CACHES];
 
 #ifdef INCLUDE_MEM_STATISTICS
     struct mem_stat    stat;
@@ -147,14 +218,24 @@ struct heap
     };
 
 STATIC_ASSERT ((sizeof (chunk_t) & ALLOC_ALIGN_MASK) == 0);
+STATIC_ASSERT (HEAP_SMALL_MAX >= sizeof (size_node_t));
 
 extern char * heap_alloc_align (heap_t * heap, size_t align, size_t bytes);
 extern char * heap_alloc       (heap_t * heap, size_t bytes);
 extern void   heap_free        (char * mem);
 extern char * heap_realloc     (heap_t * heap, char * ptr, size_t size);
+extern char * heap_alloc_ra    (heap_t * heap, size_t align, size_t bytes,
+                                void * ra);
+extern void   heap_free_ra     (char * mem, void * ra);
+extern char * heap_realloc_ra  (heap_t * heap, char * ptr, size_t size,
+                                void * ra);
+extern char * heap_isr_alloc   (heap_t * heap, size_t bytes);
+extern int    heap_isr_reserve (heap_t * heap, size_t bytes, unsigned int nr);
 
 extern int    heap_init        (heap_t * heap);
+extern int    heap_init_type   (heap_t * heap, uint8_t type);
 extern int    heap_add         (heap_t * heap, char * buff, size_t size);
+extern int    heap_frag_get    (heap_t * heap, struct heap_frag * frag);
 
 #endif  /* __HEAP_H__ */
 
@@ -17,14 +17,43 @@ modification history
 
 #include <wheel/heap.h>
 
+/*
+ * attributes of a memory region, MEM_ATTR_FAST is a preference, the others are
+ * requirements, see mem_alloc_align
+ */
+
+#define MEM_ATTR_FAST           0x1     /* zero wait state, tightly coupled */
+#define MEM_ATTR_DMA            0x2     /* reachable by the dma masters */
+#define MEM_ATTR_RETAINED       0x4     /* kept in low power modes */
+#define MEM_ATTR_UNCACHED       0x8     /* not cached, no maintenance needed */
+
+#define MEM_ATTR_REQUIRED       (MEM_ATTR_DMA | MEM_ATTR_RETAINED | \
+                                 MEM_ATTR_UNCACHED)
+
+/*
+ * each region in system_phys_mem gets a heap of its own, the first one added
+ * is kernel_heap, used by malloc. bsp should list the general purpose memory
+ * first, the order of the table is also the order of the placement fallback.
+ */
+
 struct phys_mem
     {
-    char * start;
-    char * end;
+    char         * start;
+    char         * end;
+    const char   * name;
+    unsigned int   attr;
+    heap_t       * heap;    /* set in mem_init, NULL if not usable */
     };
 
 extern heap_t          kernel_heap [1];
 extern struct phys_mem system_phys_mem [];
 
+extern int             mem_init        (void);
+extern void            mem_boot_done   (void);
+extern void          * mem_alloc_align (unsigned int attr, size_t align,
+                                        size_t size);
+extern void          * mem_alloc       (unsigned int attr, size_t size);
+extern heap_t        * mem_heap_get    (const char * name);
+
 #endif /* __MEM_H__ */
 
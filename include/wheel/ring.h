@@ -79,6 +79,38 @@ static inline unsigned char ring_peek (ring_t * ring, size_t idx)
     return ring->buff [(ring->head + idx) & (ring->size - 1)];
     }
 
+/**
+ * __ring_load - read an index of a ring updated by the other side
+ * @idx: the address of ring->head or ring->tail.
+ */
+
+static inline size_t __ring_load (size_t * idx)
+    {
+    return *(volatile size_t *) idx;
+    }
+
+/**
+ * __ring_store - publish an index of a ring to the other side
+ * @idx: the address of ring->head or ring->tail.
+ * @val: the new value.
+ */
+
+static inline void __ring_store (size_t * idx, size_t val)
+    {
+    *(volatile size_t *) idx = val;
+    }
+
+/**
+ * ring_spsc_len - get the number of bytes in a ring used by ring_spsc_*, it may
+ *                 be changed by the other side at any time after returned
+ * @ring: the ring buff.
+ */
+
+static inline size_t ring_spsc_len (ring_t * ring)
+    {
+    return __ring_load (&ring->tail) - __ring_load (&ring->head);
+    }
+
 /* externs */
 
 extern int      ring_init       (ring_t * ring, unsigned char * buff, size_t size);
@@ -90,6 +122,10 @@ extern size_t   ring_putc       (ring_t * ring, unsigned char byte);
 extern size_t   ring_putc_force (ring_t * ring, unsigned char byte);
 extern size_t   ring_get        (ring_t * ring, unsigned char * buff, size_t len);
 extern size_t   ring_getc       (ring_t * ring, unsigned char * byte);
+extern size_t   ring_spsc_put   (ring_t * ring, unsigned char * buff, size_t len);
+extern size_t   ring_spsc_putc  (ring_t * ring, unsigned char byte);
+extern size_t   ring_spsc_get   (ring_t * ring, unsigned char * buff, size_t len);
+extern size_t   ring_spsc_getc  (ring_t * ring, unsigned char * byte);
 
 #endif  /* __RING_H__ */
 
@@ -0,0 +1,207 @@
+/* seqlock.h - sequence lock and latch for lock-free publication */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+both primitives here are for one writer (or writers serialized by other means)
+and many readers, the writer never waits and never disables interrupts, the
+readers never block the writer, they just retry if the data changed during the
+read.
+
+seqcount_t protects one copy of the data, a reader must not preempt the writer
+(for example, a task reading data written by an isr is fine, but an isr reading
+data written by a task is not, as the isr will spin forever on the half-updated
+data).
+
+seqlatch_t protects two copies of the data, the writer updates one copy while
+the readers use the other, so the readers can preempt the writer at any point,
+and never spin more than once per update.
+
+    seqlatch_t latch = SEQLATCH_INIT;
+    struct snapshot snap [2];
+
+    isr:    SEQLATCH_PUBLISH (&latch, snap, new_snap);
+    task:   SEQLATCH_FETCH (&latch, snap, my_snap);
+*/
+
+#ifndef __SEQLOCK_H__
+#define __SEQLOCK_H__
+
+#include <stdbool.h>
+
+#include <wheel/compiler.h>
+
+#include <arch/sync.h>
+
+/* typedefs */
+
+typedef struct seqcount
+    {
+    volatile unsigned int seq;
+    } seqcount_t;
+
+typedef struct seqlatch
+    {
+    volatile unsigned int seq;
+    } seqlatch_t;
+
+/* macros */
+
+#define SEQCOUNT_INIT           { 0 }
+#define SEQLATCH_INIT           { 0 }
+
+/**
+ * SEQLATCH_PUBLISH - publish a new value to the two copies protected by a latch
+ * @l:      the seqlatch_t
+ * @copies: array of the two copies
+ * @val:    the new value
+ */
+
+#define SEQLATCH_PUBLISH(l, copies, val)                                    \
+    do                                                                      \
+        {                                                                   \
+        seqlatch_advance (l);                                               \
+        (copies) [0] = (val);                                               \
+        seqlatch_advance (l);                                               \
+        (copies) [1] = (val);                                               \
+        } while (0)
+
+/**
+ * SEQLATCH_FETCH - fetch a consistent value from the copies protected by a
+ *                  latch
+ * @l:      the seqlatch_t
+ * @copies: array of the two copies
+ * @out:    the lvalue to hold the value fetched
+ */
+
+#define SEQLATCH_FETCH(l, copies, out)                                      \
+    do                                                                      \
+        {                                                                   \
+        unsigned int __seq;                                                 \
+        do                                                                  \
+            {                                                               \
+            __seq = seqlatch_read_begin (l);                                \
+            (out) = (copies) [__seq & 1];                                   \
+            } while (seqlatch_read_retry (l, __seq));                       \
+        } while (0)
+
+/* inlines */
+
+/**
+ * seqcount_write_begin - start updating the data protected by a seqcount
+ * @s: the seqcount
+ *
+ * return: NA
+ */
+
+static inline void seqcount_write_begin (seqcount_t * s)
+    {
+    s->seq++;
+    wmb ();
+    }
+
+/**
+ * seqcount_write_end - finish updating the data protected by a seqcount
+ * @s: the seqcount
+ *
+ * return: NA
+ */
+
+static inline void seqcount_write_end (seqcount_t * s)
+    {
+    wmb ();
+    s->seq++;
+    }
+
+/**
+ * seqcount_read_begin - start reading the data protected by a seqcount
+ * @s: the seqcount
+ *
+ * return: the sequence to be checked by seqcount_read_retry
+ */
+
+static inline unsigned int seqcount_read_begin (seqcount_t * s)
+    {
+    unsigned int seq;
+
+    while ((seq = s->seq) & 1)
+        {
+        }
+
+    rmb ();
+
+    return seq;
+    }
+
+/**
+ * seqcount_read_retry - check if the data read is consistent
+ * @s:   the seqcount
+ * @seq: the sequence got from seqcount_read_begin
+ *
+ * return: true if the data changed during reading and must be read again
+ */
+
+static inline bool seqcount_read_retry (seqcount_t * s, unsigned int seq)
+    {
+    rmb ();
+
+    return s->seq != seq;
+    }
+
+/**
+ * seqlatch_advance - switch the readers to the other copy, the writer should
+ *                    then update the copy [0] after the first advance and the
+ *                    copy [1] after the second advance
+ * @l: the seqlatch
+ *
+ * return: NA
+ */
+
+static inline void seqlatch_advance (seqlatch_t * l)
+    {
+    wmb ();
+    l->seq++;
+    wmb ();
+    }
+
+/**
+ * seqlatch_read_begin - start reading the data protected by a seqlatch, the
+ *                       reader should use the copy [seq & 1]
+ * @l: the seqlatch
+ *
+ * return: the sequence
+ */
+
+static inline unsigned int seqlatch_read_begin (seqlatch_t * l)
+    {
+    unsigned int seq = l->seq;
+
+    rmb ();
+
+    return seq;
+    }
+
+/**
+ * seqlatch_read_retry - check if the copy read is consistent
+ * @l:   the seqlatch
+ * @seq: the sequence got from seqlatch_read_begin
+ *
+ * return: true if the copy changed during reading and must be read again
+ */
+
+static inline bool seqlatch_read_retry (seqlatch_t * l, unsigned int seq)
+    {
+    rmb ();
+
+    return l->seq != seq;
+    }
+
+#endif  /* __SEQLOCK_H__ */
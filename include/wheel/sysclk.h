@@ -0,0 +1,123 @@
+/* sysclk.h - system clock library header file */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+#ifndef __SYSCLK_H__
+#define __SYSCLK_H__
+
+#include <stdint.h>
+
+#include <wheel/config.h>
+
+/*
+the conversions use reciprocal multipliers generated at compile time from
+RTW_SYS_TIMER_FREQ and RTW_SYS_TICK_HZ, x * mult >> shift, so no 64-bit
+division is needed (which is a slow library call on cortex-m0). the results are
+rounded down.
+*/
+
+/* defines */
+
+#define SYSCLK_CYCLES_PER_TICK  (RTW_SYS_TIMER_FREQ / RTW_SYS_TICK_HZ)
+
+#define SYSCLK_CYC2NS_SHIFT     16
+#define SYSCLK_CYC2NS_MULT      ((uint32_t) ((1000000000ull << SYSCLK_CYC2NS_SHIFT) \
+                                             / RTW_SYS_TIMER_FREQ))
+#define SYSCLK_CYC2US_SHIFT     26
+#define SYSCLK_CYC2US_MULT      ((uint32_t) ((1000000ull << SYSCLK_CYC2US_SHIFT) \
+                                             / RTW_SYS_TIMER_FREQ))
+#define SYSCLK_NS2CYC_MULT      ((uint32_t) (((uint64_t) RTW_SYS_TIMER_FREQ << 32) \
+                                             / 1000000000))
+#define SYSCLK_US2CYC_MULT      ((uint32_t) (((uint64_t) RTW_SYS_TIMER_FREQ << 32) \
+                                             / 1000000))
+#define SYSCLK_CYC2TICK_MULT    ((uint32_t) ((1ull << 32) / SYSCLK_CYCLES_PER_TICK))
+
+/* inlines */
+
+/**
+ * __sysclk_mul_shift - calculate x * mult >> shift without overflow
+ * @x:     the value
+ * @mult:  the multiplier
+ * @shift: the shift, no more than 32
+ *
+ * return: the result
+ */
+
+static inline uint64_t __sysclk_mul_shift (uint64_t x, uint32_t mult,
+                                           unsigned int shift)
+    {
+    uint64_t hi = (x >> 32) * mult;
+    uint64_t lo = (uint64_t) (uint32_t) x * mult;
+
+    return (hi << (32 - shift)) + (lo >> shift);
+    }
+
+static inline uint64_t sysclk_cycles_to_ns (uint64_t cycles)
+    {
+    return __sysclk_mul_shift (cycles, SYSCLK_CYC2NS_MULT, SYSCLK_CYC2NS_SHIFT);
+    }
+
+static inline uint64_t sysclk_cycles_to_us (uint64_t cycles)
+    {
+    return __sysclk_mul_shift (cycles, SYSCLK_CYC2US_MULT, SYSCLK_CYC2US_SHIFT);
+    }
+
+static inline uint64_t sysclk_ns_to_cycles (uint64_t ns)
+    {
+    return __sysclk_mul_shift (ns, SYSCLK_NS2CYC_MULT, 32);
+    }
+
+static inline uint64_t sysclk_us_to_cycles (uint64_t us)
+    {
+    return __sysclk_mul_shift (us, SYSCLK_US2CYC_MULT, 32);
+    }
+
+static inline uint64_t sysclk_ticks_to_cycles (uint64_t ticks)
+    {
+    return ticks * SYSCLK_CYCLES_PER_TICK;
+    }
+
+static inline uint64_t sysclk_cycles_to_ticks (uint64_t cycles)
+    {
+    uint64_t ticks = __sysclk_mul_shift (cycles, SYSCLK_CYC2TICK_MULT, 32);
+
+    /* the multiplier is rounded down, fix the quotient */
+
+    while (cycles - ticks * SYSCLK_CYCLES_PER_TICK >= SYSCLK_CYCLES_PER_TICK)
+        {
+        ticks++;
+        }
+
+    return ticks;
+    }
+
+static inline uint64_t sysclk_ticks_to_us (uint64_t ticks)
+    {
+    return sysclk_cycles_to_us (sysclk_ticks_to_cycles (ticks));
+    }
+
+static inline uint64_t sysclk_us_to_ticks (uint64_t us)
+    {
+    return sysclk_cycles_to_ticks (sysclk_us_to_cycles (us));
+    }
+
+/* externs */
+
+extern int      sysclk_init          (void);
+extern uint64_t sysclk_timestamp     (void);
+extern uint64_t sysclk_cycles        (void);
+extern uint64_t sysclk_ns            (void);
+extern uint32_t sysclk_freq          (void);
+extern int      sysclk_alarm_connect (void (* pfn) (uintptr_t), uintptr_t arg);
+extern void     sysclk_alarm_set     (uint64_t cycles);
+extern void     sysclk_alarm_cancel  (void);
+
+#endif  /* __SYSCLK_H__ */
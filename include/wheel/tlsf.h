@@ -0,0 +1,58 @@
+/* tlsf.h - two-level segregated fit free chunk index header file */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+#ifndef __TLSF_H__
+#define __TLSF_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* defines */
+
+#ifndef TLSF_FL_INDEX_MAX
+#define TLSF_FL_INDEX_MAX       20  /* free chunks must be less than 1 MB */
+#endif
+
+#define TLSF_ALIGN_SHIFT        3   /* the min ALLOC_ALIGN */
+#define TLSF_SL_SHIFT           3
+#define TLSF_SL_COUNT           (1 << TLSF_SL_SHIFT)
+#define TLSF_FL_SHIFT           (TLSF_SL_SHIFT + TLSF_ALIGN_SHIFT)
+#define TLSF_FL_COUNT           (TLSF_FL_INDEX_MAX - TLSF_FL_SHIFT + 1)
+
+#define TLSF_SMALL_SIZE         (1 << TLSF_FL_SHIFT)
+#define TLSF_MAX_SIZE           (1 << TLSF_FL_INDEX_MAX)
+
+/* typedefs */
+
+struct chunk;
+
+/*
+ * free chunks are indexed by the first level (power of 2 range of the size)
+ * and the second level (linear split of the range), a bit is set in the
+ * bitmaps for every non-empty list, so both putting and getting are O(1)
+ */
+
+typedef struct tlsf
+    {
+    uint32_t           fl_bmap;
+    uint32_t           sl_bmap [TLSF_FL_COUNT];
+    struct chunk     * heads [TLSF_FL_COUNT][TLSF_SL_COUNT];
+    } tlsf_t;
+
+/* externs */
+
+extern void           tlsf_init      (tlsf_t * tlsf);
+extern void           tlsf_put_chunk (tlsf_t * tlsf, struct chunk * chunk);
+extern void           tlsf_del_chunk (tlsf_t * tlsf, struct chunk * chunk);
+extern struct chunk * tlsf_get_chunk (tlsf_t * tlsf, size_t size);
+
+#endif  /* __TLSF_H__ */
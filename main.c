@@ -33,6 +33,11 @@ int main (void)
     extern int sysclk_init ();
     sysclk_init ();
 
+    /* objects created from now on may be freed, stop using the boot arena */
+
+    extern void mem_boot_done (void);
+    mem_boot_done ();
+
     extern void sched_start (void);
     sched_start ();
 
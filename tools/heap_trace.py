@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+
+# heap_trace.py - symbolize and analyze the heap trace dumped by "memtrace"
+#
+# Copyright (c) 2026 Fangming Chai
+#
+# modification history
+# --------------------
+# 01a,19oct26,cfm  writen
+
+"""
+build with HEAP_TRACE defined, run "memtrace" in the shell and save the output,
+then:
+
+    heap_trace.py -e rtw.elf memtrace.log
+
+the records are "@ <time> <op> <task> <caller> <mem> <size>" in hex, any other
+lines in the log are ignored, so the whole console log can be fed. the ring
+only keeps the latest records, blocks allocated before the first record are
+unknown, the frees of them are only counted as churn.
+
+reports:
+
+    live      bytes allocated in the trace and not freed, per call site
+    churn     number of operations and bytes allocated, per call site
+    leaks     call sites that never got a block freed during the trace and
+              still hold blocks allocated in the first half of the trace
+"""
+
+import argparse
+import collections
+import subprocess
+import sys
+
+OP_ALLOC   = 0
+OP_FREE    = 1
+OP_REALLOC = 2
+
+Rec = collections.namedtuple ("Rec", "time op task caller mem size")
+
+def parse (lines):
+    recs = []
+
+    for line in lines:
+        fields = line.split ()
+
+        if len (fields) != 7 or fields [0] != "@":
+            continue
+
+        try:
+            vals = [int (f, 16) for f in fields [1:]]
+        except ValueError:
+            continue
+
+        recs.append (Rec (*vals))
+
+    return recs
+
+def symbolize (addrs, elf, addr2line):
+    """map return addresses to "func (file:line)" of the call instruction"""
+
+    names = {a: "0x%08x" % a for a in addrs}
+
+    if elf is None or not addrs:
+        return names
+
+    addrs = sorted (addrs)
+
+    # clear the thumb bit and step back into the branch instruction
+
+    args  = [addr2line, "-f", "-e", elf] + ["0x%x" % max ((a & ~1) - 2, 0)
+                                            for a in addrs]
+
+    try:
+        out = subprocess.run (args, stdout = subprocess.PIPE, check = True,
+                              universal_newlines = True).stdout.splitlines ()
+    except (OSError, subprocess.CalledProcessError) as e:
+        print ("warning: %s failed (%s), addresses not symbolized" %
+               (addr2line, e), file = sys.stderr)
+        return names
+
+    for i, a in enumerate (addrs):
+        if 2 * i + 1 >= len (out):
+            break
+
+        func = out [2 * i]
+        loc  = out [2 * i + 1].rsplit ("/", 1) [-1]
+
+        names [a] = "%s (%s)" % (func, loc)
+
+    return names
+
+class Site:
+    def __init__ (self):
+        self.ops         = 0
+        self.allocs      = 0
+        self.frees       = 0
+        self.fails       = 0
+        self.bytes_alloc = 0
+        self.live_bytes  = 0
+        self.live_blocks = 0
+        self.dropped     = False
+
+def analyze (recs):
+    sites = collections.defaultdict (Site)
+    live  = {}                          # mem -> (site, size, index)
+
+    for idx, r in enumerate (recs):
+        site = sites [r.caller]
+        site.ops += 1
+
+        if r.op == OP_FREE:
+            site.frees += 1
+
+            if r.mem in live:
+                owner, size, _ = live.pop (r.mem)
+                s = sites [owner]
+                s.live_bytes  -= size
+                s.live_blocks -= 1
+                s.dropped      = True
+            continue
+
+        if r.mem == 0:
+            site.fails += 1
+            continue
+
+        site.allocs      += 1
+        site.bytes_alloc += r.size
+        site.live_bytes  += r.size
+        site.live_blocks += 1
+
+        live [r.mem] = (r.caller, r.size, idx)
+
+    return sites, live
+
+def main ():
+    parser = argparse.ArgumentParser (description = "analyze a heap trace")
+    parser.add_argument ("log", nargs = "?", help = "memtrace output, stdin if omitted")
+    parser.add_argument ("-e", "--elf", help = "the elf to symbolize against")
+    parser.add_argument ("-a", "--addr2line", default = "arm-none-eabi-addr2line",
+                         help = "the addr2line to use (%(default)s)")
+    parser.add_argument ("-n", "--top", type = int, default = 10,
+                         help = "number of sites in each report (%(default)s)")
+    opts = parser.parse_args ()
+
+    if opts.log is None:
+        recs = parse (sys.stdin)
+    else:
+        with open (opts.log) as f:
+            recs = parse (f)
+
+    if not recs:
+        print ("no heap trace record found")
+        return 1
+
+    sites, live = analyze (recs)
+    names       = symbolize (set (sites), opts.elf, opts.addr2line)
+    top         = opts.top
+
+    print ("%d records, %d call sites, %d blocks live\n" %
+           (len (recs), len (sites), len (live)))
+
+    print ("live bytes by call site:")
+    for a, s in sorted (sites.items (), key = lambda i: -i [1].live_bytes) [:top]:
+        if s.live_bytes > 0:
+            print ("  %8d bytes %5d blocks  %s" %
+                   (s.live_bytes, s.live_blocks, names [a]))
+
+    print ("\nchurn hotspots:")
+    for a, s in sorted (sites.items (), key = lambda i: -i [1].ops) [:top]:
+        print ("  %6d ops (%d alloc %d free %d fail) %8d bytes  %s" %
+               (s.ops, s.allocs, s.frees, s.fails, s.bytes_alloc, names [a]))
+
+    print ("\nleak candidates:")
+    old   = collections.Counter (site for site, _, idx in live.values ()
+                                 if idx < len (recs) // 2)
+    found = False
+    for a, s in sorted (sites.items (), key = lambda i: -i [1].live_bytes):
+        if s.live_bytes > 0 and not s.dropped and old [a] > 0:
+            found = True
+            print ("  %8d bytes %5d blocks (%d old)  %s" %
+                   (s.live_bytes, s.live_blocks, old [a], names [a]))
+    if not found:
+        print ("  none")
+
+    return 0
+
+if __name__ == "__main__":
+    sys.exit (main ())
@@ -0,0 +1,634 @@
+/* heapbench.c - host benchmark and trace replay for the heap */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+core/mem/heap.c, tlsf.c and utils/crbtree.c are built natively on the host with
+the few kernel services they use stubbed out, so the allocator can be measured
+and compared without a board:
+
+    heapbench [-b backend] [-w workload] [-t trace] [-n ops] [-s size]
+              [-i interval] [-S seed]
+
+    -b  rbtree, tlsf, glibc or all (default)
+    -w  uniform, powerlaw, prodcons or all (default), synthetic workloads
+    -t  replay a trace dumped by the "memtrace" command instead
+    -n  number of operations of a synthetic workload (100000)
+    -s  size of the heap buffer in bytes (32768)
+    -i  sample the fragmentation every <interval> operations (0 = no samples)
+    -S  seed of the synthetic workloads
+
+workloads:
+
+    uniform   random alloc/free on HB_SLOTS slots, sizes uniform in [1, 256]
+    powerlaw  the same, sizes in a pareto like distribution, mostly small
+              blocks with a few up to 2k
+    prodcons  a producer allocates messages into a fifo, a consumer frees them
+              from the other end, the fifo depth swings between 0 and
+              HB_SLOTS, like a driver queue with bursts
+
+a trace is the output of "memtrace" (see tools/heap_trace.py), the recorded
+addresses are mapped to the blocks allocated here, a realloc is replayed as the
+free before it plus an allocation. frees of blocks allocated before the first
+record are skipped.
+
+each operation is timed with clock_gettime, the latency percentiles of alloc
+and free, the throughput and the number of failed allocations are reported.
+glibc malloc is not bounded by the heap size, so it never fails and has no
+fragmentation samples, it is only the reference of the latency.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+
+#include <wheel/heap.h>
+#include <wheel/irq.h>
+
+#include <kernel/mutex.h>
+
+/* defines */
+
+#define HB_SLOTS                256
+#define HB_DEF_OPS              100000
+#define HB_DEF_SIZE             32768
+#define HB_DEF_SEED             0x2545f491u
+#define HB_MAX_TRACE            65536
+#define HB_TRACE_FREE           1       /* HEAP_TRACE_FREE */
+
+/* typedefs */
+
+struct hb_op
+    {
+    uint32_t size;          /* 0 for free */
+    uint32_t slot;
+    };
+
+struct hb_trace
+    {
+    struct hb_op * ops;
+    uint32_t       nr;
+    uint32_t       slots;
+    };
+
+struct hb_backend
+    {
+    const char * name;
+    int          type;      /* HEAP_TYPE_*, -1 for glibc */
+    };
+
+/* locals */
+
+static const struct hb_backend backends [] =
+    {
+    { "rbtree", HEAP_TYPE_RBTREE },
+    { "tlsf",   HEAP_TYPE_TLSF   },
+    { "glibc",  -1               },
+    };
+
+static const char * const workloads [] = { "uniform", "powerlaw", "prodcons" };
+
+static heap_t    hb_heap;
+static uint64_t * hb_buff;
+static size_t    hb_size     = HB_DEF_SIZE;
+static uint32_t  hb_interval = 0;
+
+/* host stubs of the kernel services used by heap.c */
+
+unsigned int int_cnt = 0;
+
+unsigned long int_lock (void)
+    {
+    return 0;
+    }
+
+void int_unlock (unsigned long flags)
+    {
+    (void) flags;
+    }
+
+int mutex_init (mutex_id mutex)
+    {
+    (void) mutex;
+    return 0;
+    }
+
+int mutex_lock (mutex_id mutex)
+    {
+    (void) mutex;
+    return 0;
+    }
+
+int mutex_unlock (mutex_id mutex)
+    {
+    (void) mutex;
+    return 0;
+    }
+
+static inline uint32_t __hb_rand (uint32_t * seed)
+    {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+
+    return *seed;
+    }
+
+static inline uint64_t __hb_ns (void)
+    {
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    }
+
+static int __hb_cmp (const void * a, const void * b)
+    {
+    uint32_t x = *(const uint32_t *) a;
+    uint32_t y = *(const uint32_t *) b;
+
+    return x < y ? -1 : x > y;
+    }
+
+/**
+ * __hb_size - get a random block size of a workload
+ * @workload: index in workloads []
+ * @seed:     the random seed
+ *
+ * return: the size, at least 1
+ */
+
+static uint32_t __hb_size (int workload, uint32_t * seed)
+    {
+    uint32_t r = __hb_rand (seed);
+
+    if (workload != 1)
+        {
+        return 1 + r % 256;
+        }
+
+    /* 16 / u ^ 1.5 capped at 2k, inverse cdf of pareto with alpha = 2 / 3 */
+
+    double u = ((r >> 8) + 1) / 16777217.0;
+    double s = 16.0 / (u * sqrt (u));
+
+    return s > 2048.0 ? 2048 : (uint32_t) s;
+    }
+
+/**
+ * __hb_synth - generate a synthetic workload
+ * @workload: index in workloads []
+ * @nr:       number of operations
+ * @seed:     the random seed
+ * @trace:    the trace generated
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+static int __hb_synth (int workload, uint32_t nr, uint32_t seed,
+                       struct hb_trace * trace)
+    {
+    uint8_t  busy [HB_SLOTS] = {0, };
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    uint32_t i;
+    uint32_t slot;
+
+    if ((trace->ops = malloc (sizeof (struct hb_op) * nr)) == NULL)
+        {
+        return -1;
+        }
+
+    seed |= 1;
+
+    trace->nr    = nr;
+    trace->slots = HB_SLOTS;
+
+    for (i = 0; i < nr; i++)
+        {
+        if (workload == 2)
+            {
+
+            /*
+             * phases of 256 operations, 3 / 4 of them produce in the first
+             * phase, and consume in the second one, depth in [0, HB_SLOTS]
+             */
+
+            int produce = (__hb_rand (&seed) & 3) != 0;
+
+            if ((i >> 8) & 1)
+                {
+                produce = !produce;
+                }
+
+            if (head == tail)
+                {
+                produce = 1;
+                }
+            else if (head - tail == HB_SLOTS)
+                {
+                produce = 0;
+                }
+
+            if (produce)
+                {
+                trace->ops [i].slot = head++ % HB_SLOTS;
+                trace->ops [i].size = __hb_size (workload, &seed);
+                }
+            else
+                {
+                trace->ops [i].slot = tail++ % HB_SLOTS;
+                trace->ops [i].size = 0;
+                }
+
+            continue;
+            }
+
+        slot = __hb_rand (&seed) % HB_SLOTS;
+
+        trace->ops [i].slot = slot;
+        trace->ops [i].size = busy [slot] ? 0 : __hb_size (workload, &seed);
+
+        busy [slot] = !busy [slot];
+        }
+
+    return 0;
+    }
+
+/**
+ * __hb_load - load a trace dumped by the "memtrace" command
+ * @file:  the file name, "-" for stdin
+ * @trace: the trace loaded
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+static int __hb_load (const char * file, struct hb_trace * trace)
+    {
+    FILE         * fp = strcmp (file, "-") == 0 ? stdin : fopen (file, "r");
+    unsigned long  addrs [HB_SLOTS * 4];
+    uint8_t        used  [HB_SLOTS * 4] = {0, };
+    unsigned long  stamp, op, task, caller, mem, size;
+    char           line [256];
+    uint32_t       slot;
+
+    if (fp == NULL)
+        {
+        perror (file);
+        return -1;
+        }
+
+    if ((trace->ops = malloc (sizeof (struct hb_op) * HB_MAX_TRACE)) == NULL)
+        {
+        return -1;
+        }
+
+    trace->nr    = 0;
+    trace->slots = HB_SLOTS * 4;
+
+    while ((trace->nr < HB_MAX_TRACE) && fgets (line, sizeof (line), fp))
+        {
+        if (sscanf (line, "@ %lx %lx %lx %lx %lx %lx", &stamp, &op, &task,
+                    &caller, &mem, &size) != 6)
+            {
+            continue;
+            }
+
+        if (mem == 0)
+            {
+            continue;       /* failed allocation */
+            }
+
+        for (slot = 0; slot < trace->slots; slot++)
+            {
+            if (used [slot] && (addrs [slot] == mem))
+                {
+                break;
+                }
+            }
+
+        if (op == HB_TRACE_FREE)
+            {
+            if (slot == trace->slots)
+                {
+                continue;   /* allocated before the trace started */
+                }
+
+            used [slot] = 0;
+
+            trace->ops [trace->nr].slot   = slot;
+            trace->ops [trace->nr++].size = 0;
+
+            continue;
+            }
+
+        for (slot = 0; slot < trace->slots && used [slot]; slot++)
+            ;
+
+        if (slot == trace->slots)
+            {
+            fprintf (stderr, "too many live blocks in the trace\n");
+            break;
+            }
+
+        used  [slot] = 1;
+        addrs [slot] = mem;
+
+        trace->ops [trace->nr].slot   = slot;
+        trace->ops [trace->nr++].size = size == 0 ? 1 : (uint32_t) size;
+        }
+
+    if (fp != stdin)
+        {
+        fclose (fp);
+        }
+
+    return trace->nr == 0 ? -1 : 0;
+    }
+
+static void * __hb_alloc (int type, size_t size)
+    {
+    return type < 0 ? malloc (size) : (void *) heap_alloc (&hb_heap, size);
+    }
+
+static void __hb_free (int type, void * mem)
+    {
+    if (type < 0)
+        {
+        free (mem);
+        }
+    else
+        {
+        heap_free (mem);
+        }
+    }
+
+/**
+ * __hb_pct - print the percentiles of latencies
+ * @name: the name of the operation
+ * @lat:  the latencies in ns
+ * @nr:   number of latencies
+ *
+ * return: NA
+ */
+
+static void __hb_pct (const char * name, uint32_t * lat, uint32_t nr)
+    {
+    if (nr == 0)
+        {
+        printf ("  %-5s  none\n", name);
+        return;
+        }
+
+    qsort (lat, nr, sizeof (uint32_t), __hb_cmp);
+
+    printf ("  %-5s  p50 %6u ns  p99 %6u ns  max %8u ns  (%u ops)\n", name,
+            lat [nr / 2], lat [(uint32_t) (nr * 0.99)], lat [nr - 1], nr);
+    }
+
+/**
+ * __hb_run - replay a trace on a backend and report
+ * @be:    the backend
+ * @trace: the trace
+ *
+ * return: 0 on success, negtive value on error
+ */
+
+static int __hb_run (const struct hb_backend * be, struct hb_trace * trace)
+    {
+    void          ** slots = calloc (trace->slots, sizeof (void *));
+    uint32_t       * alat  = malloc (sizeof (uint32_t) * trace->nr);
+    uint32_t       * flat  = malloc (sizeof (uint32_t) * trace->nr);
+    uint32_t         nr_alloc = 0;
+    uint32_t         nr_free  = 0;
+    uint32_t         fails    = 0;
+    uint64_t         total    = 0;
+    uint64_t         t;
+    struct heap_frag frag;
+    uint32_t         i;
+
+    if ((slots == NULL) || (alat == NULL) || (flat == NULL))
+        {
+        return -1;
+        }
+
+    if (be->type >= 0)
+        {
+        memset (&hb_heap, 0, sizeof (hb_heap));
+
+        if ((heap_init_type (&hb_heap, (uint8_t) be->type) != 0) ||
+            (heap_add (&hb_heap, (char *) hb_buff, hb_size) != 0))
+            {
+            fprintf (stderr, "%s: fail to create the heap\n", be->name);
+            return -1;
+            }
+        }
+
+    printf ("%s:\n", be->name);
+
+    for (i = 0; i < trace->nr; i++)
+        {
+        struct hb_op * op = &trace->ops [i];
+
+        t = 0;
+
+        if (op->size == 0)
+            {
+            if (slots [op->slot] == NULL)
+                {
+                goto sample;    /* the allocation failed */
+                }
+
+            t = __hb_ns ();
+            __hb_free (be->type, slots [op->slot]);
+            t = __hb_ns () - t;
+
+            slots [op->slot]  = NULL;
+            flat [nr_free++]  = (uint32_t) t;
+            }
+        else
+            {
+            if (slots [op->slot] != NULL)
+                {
+                __hb_free (be->type, slots [op->slot]);     /* lost by trace */
+                }
+
+            t = __hb_ns ();
+            slots [op->slot] = __hb_alloc (be->type, op->size);
+            t = __hb_ns () - t;
+
+            alat [nr_alloc++] = (uint32_t) t;
+
+            if (slots [op->slot] == NULL)
+                {
+                fails++;
+                }
+            else
+                {
+                memset (slots [op->slot], 0xa5, op->size < 64 ? op->size : 64);
+                }
+            }
+
+        total += t;
+
+sample:
+        if ((hb_interval == 0) || (be->type < 0) || ((i + 1) % hb_interval))
+            {
+            continue;
+            }
+
+        if (heap_frag_get (&hb_heap, &frag) == 0)
+            {
+            printf ("  @%-8u busy %7u free %7u largest %7u frag %3u%% "
+                    "chunks %u\n", i + 1, (unsigned int) frag.busy_size,
+                    (unsigned int) frag.free_size,
+                    (unsigned int) frag.max_free, frag.frag,
+                    frag.free_chunks);
+            }
+        }
+
+    __hb_pct ("alloc", alat, nr_alloc);
+    __hb_pct ("free",  flat, nr_free);
+
+    printf ("  %u ops in %.3f ms, %.2f Mops/s, %u failed allocations\n",
+            nr_alloc + nr_free, total / 1e6,
+            total ? (nr_alloc + nr_free) * 1e3 / total : 0.0, fails);
+
+    if ((be->type >= 0) && (heap_frag_get (&hb_heap, &frag) == 0))
+        {
+        printf ("  end: busy %u free %u largest %u frag %u%%\n",
+                (unsigned int) frag.busy_size, (unsigned int) frag.free_size,
+                (unsigned int) frag.max_free, frag.frag);
+        }
+
+    for (i = 0; i < trace->slots; i++)
+        {
+        if (slots [i] != NULL)
+            {
+            __hb_free (be->type, slots [i]);
+            }
+        }
+
+    free (slots);
+    free (alat);
+    free (flat);
+
+    return 0;
+    }
+
+static int __hb_usage (const char * prog)
+    {
+    fprintf (stderr, "usage: %s [-b rbtree|tlsf|glibc|all] "
+             "[-w uniform|powerlaw|prodcons|all] [-t trace] [-n ops] "
+             "[-s size] [-i interval] [-S seed]\n", prog);
+
+    return 1;
+    }
+
+int main (int argc, char * argv [])
+    {
+    const char    * backend  = "all";
+    const char    * workload = "all";
+    const char    * file     = NULL;
+    uint32_t        nr       = HB_DEF_OPS;
+    uint32_t        seed     = HB_DEF_SEED;
+    struct hb_trace trace;
+    size_t          b;
+    size_t          w;
+    int             opt;
+    int             ret      = 0;
+
+    while ((opt = getopt (argc, argv, "b:w:t:n:s:i:S:")) != -1)
+        {
+        switch (opt)
+            {
+            case 'b': backend     = optarg;                          break;
+            case 'w': workload    = optarg;                          break;
+            case 't': file        = optarg;                          break;
+            case 'n': nr          = strtoul (optarg, NULL, 0);       break;
+            case 's': hb_size     = strtoul (optarg, NULL, 0);       break;
+            case 'i': hb_interval = strtoul (optarg, NULL, 0);       break;
+            case 'S': seed        = strtoul (optarg, NULL, 0);       break;
+            default:  return __hb_usage (argv [0]);
+            }
+        }
+
+    if ((nr == 0) || (hb_size < MIN_HEAP_SIZE))
+        {
+        return __hb_usage (argv [0]);
+        }
+
+    if ((hb_buff = malloc (round_up (hb_size, sizeof (uint64_t)))) == NULL)
+        {
+        return 1;
+        }
+
+    for (w = 0; w < ARRAY_SIZE (workloads); w++)
+        {
+        if (file != NULL)
+            {
+            if (__hb_load (file, &trace) != 0)
+                {
+                fprintf (stderr, "no trace record found in %s\n", file);
+                return 1;
+                }
+
+            printf ("== trace %s, %u operations, heap %u bytes\n", file,
+                    trace.nr, (unsigned int) hb_size);
+            }
+        else
+            {
+            if (strcmp (workload, "all") && strcmp (workload, workloads [w]))
+                {
+                continue;
+                }
+
+            if (__hb_synth ((int) w, nr, seed, &trace) != 0)
+                {
+                return 1;
+                }
+
+            printf ("== %s, %u operations, heap %u bytes\n", workloads [w],
+                    nr, (unsigned int) hb_size);
+            }
+
+        for (b = 0; b < ARRAY_SIZE (backends); b++)
+            {
+            if (strcmp (backend, "all") && strcmp (backend, backends [b].name))
+                {
+                continue;
+                }
+
+            if (__hb_run (&backends [b], &trace) != 0)
+                {
+                ret = 1;
+                }
+            }
+
+        free (trace.ops);
+
+        if (file != NULL)
+            {
+            break;
+            }
+        }
+
+    free (hb_buff);
+
+    return ret;
+    }
@@ -0,0 +1,21 @@
+/* config.h - host arch config for the host builds of the tools */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+#ifndef __HOST_CONFIG_H__
+#define __HOST_CONFIG_H__
+
+/* macros */
+
+#define ALLOC_ALIGN                 8
+#define STACK_ALIGN                 8
+
+#endif  /* __HOST_CONFIG_H__ */
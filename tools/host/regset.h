@@ -0,0 +1,25 @@
+/* regset.h - host register set for the host builds of the tools */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+#ifndef __HOST_REGSET_H__
+#define __HOST_REGSET_H__
+
+#include <stdint.h>
+
+/* the tools never switch tasks, only the size is used by task.h */
+
+struct regset
+    {
+    uintptr_t pc;
+    };
+
+#endif  /* __HOST_REGSET_H__ */
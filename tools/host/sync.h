@@ -0,0 +1,55 @@
+/* sync.h - host barriers for the host builds of the tools */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+picked by arch/arch-dispatch.h with -Darchdir=host, the barriers are the gcc
+atomic fences so the ring_spsc_* routines are checked with real threads on
+weakly ordered hosts too
+*/
+
+#ifndef __HOST_SYNC_H__
+#define __HOST_SYNC_H__
+
+/**
+ * mb - read write memory barrier
+ *
+ * return: NA
+ */
+
+static inline void mb (void)
+    {
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    }
+
+/**
+ * rmb - read memory barrier
+ *
+ * return: NA
+ */
+
+static inline void rmb (void)
+    {
+    __atomic_thread_fence (__ATOMIC_ACQUIRE);
+    }
+
+/**
+ * wmb - write memory barrier
+ *
+ * return: NA
+ */
+
+static inline void wmb (void)
+    {
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+    }
+
+#endif  /* __HOST_SYNC_H__ */
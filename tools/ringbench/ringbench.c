@@ -0,0 +1,401 @@
+/* ringbench.c - host stress test and benchmark of the spsc ring */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+utils/ring.c is built natively on the host with the barriers of tools/host,
+a producer thread and a consumer thread play the isr and the task:
+
+    ringbench [-m mode] [-n bytes] [-s ring_size] [-S seed]
+
+    -m  stress, bench or all (default)
+    -n  number of bytes passed through the ring (16M)
+    -s  size of the ring, power of 2 (256, as HAL_UART_RING_SIZE)
+    -S  seed of the stress test
+
+stress    the producer puts a known byte sequence with ring_spsc_put and
+          ring_spsc_putc in random sized pieces, the consumer gets it back
+          with ring_spsc_get and ring_spsc_getc in other random sized pieces
+          and checks every byte, it is run on the given ring size and on a 4
+          bytes ring so the indexes wrap all the time
+
+bench     the throughput of ring_spsc_* is compared with ring_put/ring_get
+          protected by a spin lock (the int_lock of the target), byte by byte
+          and in 64 bytes pieces
+
+both sides yield the cpu when the ring is full or empty, so the test works on
+a single cpu host too, with the threads preempted at any point like the isr.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include <wheel/common.h>
+#include <wheel/ring.h>
+
+/* defines */
+
+#define RB_DEF_BYTES            (16u << 20)
+#define RB_DEF_SIZE             256
+#define RB_DEF_SEED             0x6b8b4567u
+#define RB_PIECE                64
+
+/* typedefs */
+
+struct rb_run
+    {
+    ring_t           * ring;
+    uint64_t           bytes;
+    unsigned int       piece;   /* 1 for putc/getc, 0 for random pieces */
+    int                locked;  /* ring_put/ring_get under rb_lock */
+    uint32_t           seed;
+    uint64_t           errors;  /* bytes got out of sequence */
+    };
+
+struct rb_variant
+    {
+    const char       * name;
+    unsigned int       piece;
+    int                locked;
+    };
+
+/* locals */
+
+static const struct rb_variant variants [] =
+    {
+    { "spsc/1",  1,        0 },
+    { "lock/1",  1,        1 },
+    { "spsc/64", RB_PIECE, 0 },
+    { "lock/64", RB_PIECE, 1 },
+    };
+
+static pthread_spinlock_t rb_lock;
+
+static inline uint32_t __rb_rand (uint32_t * seed)
+    {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+
+    return *seed;
+    }
+
+static inline uint64_t __rb_ns (void)
+    {
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    }
+
+/* the byte <i> of the sequence, a lost, doubled or reordered byte changes it */
+
+static inline unsigned char __rb_byte (uint64_t i)
+    {
+    return (unsigned char) (i ^ (i >> 8) ^ (i >> 16) ^ (i >> 24));
+    }
+
+static inline unsigned int __rb_piece (struct rb_run * run, size_t size)
+    {
+    if (run->piece != 0)
+        {
+        return run->piece;
+        }
+
+    return 1 + __rb_rand (&run->seed) % (size + size / 2);
+    }
+
+static size_t __rb_put (struct rb_run * run, unsigned char * buff, size_t len)
+    {
+    size_t ret;
+
+    if (run->locked)
+        {
+        pthread_spin_lock (&rb_lock);
+
+        ret = len == 1 ? ring_putc (run->ring, buff [0]) :
+                         ring_put (run->ring, buff, len);
+
+        pthread_spin_unlock (&rb_lock);
+
+        return ret;
+        }
+
+    return len == 1 ? ring_spsc_putc (run->ring, buff [0]) :
+                      ring_spsc_put (run->ring, buff, len);
+    }
+
+static size_t __rb_get (struct rb_run * run, unsigned char * buff, size_t len)
+    {
+    size_t ret;
+
+    if (run->locked)
+        {
+        pthread_spin_lock (&rb_lock);
+
+        ret = len == 1 ? ring_getc (run->ring, buff) :
+                         ring_get (run->ring, buff, len);
+
+        pthread_spin_unlock (&rb_lock);
+
+        return ret;
+        }
+
+    return len == 1 ? ring_spsc_getc (run->ring, buff) :
+                      ring_spsc_get (run->ring, buff, len);
+    }
+
+static void * __rb_producer (void * arg)
+    {
+    struct rb_run * run  = (struct rb_run *) arg;
+    unsigned char * buff = malloc (run->ring->size * 2);
+    uint64_t        done = 0;
+    size_t          len;
+    size_t          ret;
+    size_t          i;
+
+    while (done < run->bytes)
+        {
+        len = min (__rb_piece (run, run->ring->size), run->bytes - done);
+
+        for (i = 0; i < len; i++)
+            {
+            buff [i] = __rb_byte (done + i);
+            }
+
+        /* a piece may be put in parts when the ring is nearly full */
+
+        for (i = 0; i < len; i += ret)
+            {
+            while ((ret = __rb_put (run, buff + i, len - i)) == 0)
+                {
+                sched_yield ();
+                }
+            }
+
+        done += len;
+        }
+
+    free (buff);
+
+    return NULL;
+    }
+
+static void * __rb_consumer (void * arg)
+    {
+    struct rb_run * run  = (struct rb_run *) arg;
+    unsigned char * buff = malloc (run->ring->size * 2);
+    uint64_t        done = 0;
+    size_t          len;
+    size_t          ret;
+    size_t          i;
+
+    while (done < run->bytes)
+        {
+        len = min (__rb_piece (run, run->ring->size), run->bytes - done);
+
+        if ((ret = __rb_get (run, buff, len)) == 0)
+            {
+            sched_yield ();
+            continue;
+            }
+
+        for (i = 0; i < ret; i++)
+            {
+            if (buff [i] != __rb_byte (done + i))
+                {
+                run->errors++;
+                }
+            }
+
+        done += ret;
+        }
+
+    free (buff);
+
+    return NULL;
+    }
+
+/**
+ * __rb_run - pass the bytes through a ring with a producer and a consumer
+ * @run:  the run, <ring> and <bytes> set, <errors> is filled
+ * @prod: the producer arguments, a copy of <run> with its own seed
+ *
+ * return: the time used in ns
+ */
+
+static uint64_t __rb_run (struct rb_run * run, struct rb_run * prod)
+    {
+    pthread_t producer;
+    uint64_t  t;
+
+    ring_reset (run->ring);
+
+    t = __rb_ns ();
+
+    if (pthread_create (&producer, NULL, __rb_producer, prod) != 0)
+        {
+        perror ("pthread_create");
+        exit (1);
+        }
+
+    (void) __rb_consumer (run);
+
+    pthread_join (producer, NULL);
+
+    return __rb_ns () - t;
+    }
+
+static int __rb_stress (size_t size, uint64_t bytes, uint32_t seed)
+    {
+    size_t        sizes [] = { size, 4 };
+    struct rb_run cons;
+    struct rb_run prod;
+    ring_t      * ring;
+    uint64_t      ns;
+    size_t        i;
+    int           ret = 0;
+
+    for (i = 0; i < ARRAY_SIZE (sizes); i++)
+        {
+        if ((ring = ring_create (sizes [i])) == NULL)
+            {
+            return 1;
+            }
+
+        memset (&cons, 0, sizeof (cons));
+
+        cons.ring  = ring;
+        cons.bytes = bytes;
+        cons.seed  = seed;
+
+        prod       = cons;
+        prod.seed  = seed * 2654435761u;
+
+        ns = __rb_run (&cons, &prod);
+
+        printf ("stress ring %5u: %llu bytes in %.3f s, %llu errors\n",
+                (unsigned int) sizes [i], (unsigned long long) bytes,
+                ns / 1e9, (unsigned long long) cons.errors);
+
+        if (cons.errors != 0)
+            {
+            ret = 1;
+            }
+
+        ring_destroy (ring);
+        }
+
+    return ret;
+    }
+
+static int __rb_bench (size_t size, uint64_t bytes)
+    {
+    struct rb_run cons;
+    struct rb_run prod;
+    ring_t      * ring;
+    uint64_t      ns;
+    size_t        v;
+    int           ret = 0;
+
+    if ((ring = ring_create (size)) == NULL)
+        {
+        return 1;
+        }
+
+    pthread_spin_init (&rb_lock, PTHREAD_PROCESS_PRIVATE);
+
+    printf ("%8s %10s %10s   (ring %u bytes)\n", "variant", "MB/s",
+            "ns/byte", (unsigned int) size);
+
+    for (v = 0; v < ARRAY_SIZE (variants); v++)
+        {
+        memset (&cons, 0, sizeof (cons));
+
+        cons.ring   = ring;
+        cons.bytes  = bytes;
+        cons.piece  = variants [v].piece;
+        cons.locked = variants [v].locked;
+        cons.seed   = RB_DEF_SEED;
+
+        prod        = cons;
+
+        ns = __rb_run (&cons, &prod);
+
+        printf ("%8s %10.1f %10.2f\n", variants [v].name,
+                bytes * 1e3 / ns, (double) ns / bytes);
+
+        if (cons.errors != 0)
+            {
+            fprintf (stderr, "%s: %llu errors\n", variants [v].name,
+                     (unsigned long long) cons.errors);
+            ret = 1;
+            }
+        }
+
+    pthread_spin_destroy (&rb_lock);
+
+    ring_destroy (ring);
+
+    return ret;
+    }
+
+int main (int argc, char * argv [])
+    {
+    const char * mode  = "all";
+    uint64_t     bytes = RB_DEF_BYTES;
+    size_t       size  = RB_DEF_SIZE;
+    uint32_t     seed  = RB_DEF_SEED;
+    int          opt;
+    int          ret   = 0;
+
+    while ((opt = getopt (argc, argv, "m:n:s:S:")) != -1)
+        {
+        switch (opt)
+            {
+            case 'm': mode  = optarg;                          break;
+            case 'n': bytes = strtoull (optarg, NULL, 0);      break;
+            case 's': size  = strtoul (optarg, NULL, 0);       break;
+            case 'S': seed  = strtoul (optarg, NULL, 0);       break;
+            default:
+                fprintf (stderr, "usage: %s [-m stress|bench|all] [-n bytes] "
+                         "[-s ring_size] [-S seed]\n", argv [0]);
+                return 1;
+            }
+        }
+
+    if ((bytes == 0) || (size < 4) || (size & (size - 1)) || (seed == 0))
+        {
+        fprintf (stderr, "bad arguments\n");
+        return 1;
+        }
+
+    if (!strcmp (mode, "all") || !strcmp (mode, "stress"))
+        {
+        ret |= __rb_stress (size, bytes, seed);
+        }
+
+    if (!strcmp (mode, "all") || !strcmp (mode, "bench"))
+        {
+        ret |= __rb_bench (size, bytes);
+        }
+
+    return ret;
+    }
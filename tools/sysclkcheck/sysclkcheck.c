@@ -0,0 +1,266 @@
+/* sysclkcheck.c - host check of the system clock on simulated timers */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+core/services/sysclk.c and core/hal/hal_timer.c are built natively on the host
+and driven by a simulated system timer, the time is moved on by random steps,
+the tick isr is invoked at every period, and sysclk_cycles is read after every
+step. every read must not be less than the read before and must be the exact
+number of cycles simulated.
+
+    sysclkcheck [-t timer] [-n steps] [-S seed]
+
+    -t  down, up, free or all (default)
+    -n  number of steps of each timer (1000000)
+    -S  seed of the steps
+
+timers:
+
+    down  counting down from the reload value, reset every period, like
+          drivers/timer/systick.c, the tick isr is run at the reload
+    up    counting up to the compare value, reset every period
+    free  free running 24 bits up counter, like the nrf51 rtc, the tick isr
+          is delayed by random steps as if it is pending or preempted
+
+each timer is checked in a child process, as the system clock can be started
+only once.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <wheel/common.h>
+#include <wheel/config.h>
+#include <wheel/hal_timer.h>
+#include <wheel/sysclk.h>
+
+/* defines */
+
+#define SC_DEF_STEPS            1000000
+#define SC_DEF_SEED             0x19a3f7c1u
+
+#define SC_FREE_MAX             0xffffffu
+
+/* typedefs */
+
+struct sc_timer
+    {
+    const char * name;
+    bool         down;
+    bool         free_run;
+    };
+
+/* locals */
+
+static const struct sc_timer sc_timers [] =
+    {
+    { "down", true,  false },
+    { "up",   false, false },
+    { "free", false, true  },
+    };
+
+static uint64_t    sc_now;          /* cycles simulated */
+static uint64_t    sc_ticked;       /* cycles at the latest tick isr run */
+static hal_timer_t sc_timer;
+
+/* host stubs of the kernel services used by sysclk.c */
+
+void tick_shot_n (unsigned int ticks)
+    {
+    (void) ticks;
+    }
+
+int do_critical (int (* job) (uintptr_t, uintptr_t), uintptr_t arg1,
+                 uintptr_t arg2)
+    {
+    return job (arg1, arg2);
+    }
+
+static inline uint32_t __sc_rand (uint32_t * seed)
+    {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+
+    return *seed;
+    }
+
+/* the simulated timer, the raw counter as the hardware register */
+
+static int __sc_enable (hal_timer_t * timer, uint64_t cmp_rld)
+    {
+    (void) timer;
+    (void) cmp_rld;
+
+    return 0;
+    }
+
+static int __sc_connect (hal_timer_t * timer, void (* pfn) (uintptr_t),
+                         uintptr_t arg)
+    {
+    (void) timer;
+    (void) pfn;
+    (void) arg;
+
+    return 0;
+    }
+
+static uint64_t __sc_counter (hal_timer_t * timer)
+    {
+    uint64_t elapsed;
+
+    if (timer->free_run)
+        {
+        return sc_now & timer->max_count;
+        }
+
+    /* the counter is reset at the tick, which is never late here */
+
+    elapsed = sc_now - sc_ticked;
+
+    return timer->down ? timer->cmp_rld - elapsed : elapsed;
+    }
+
+static const hal_timer_methods_t sc_methods =
+    {
+    __sc_enable,
+    NULL,
+    __sc_connect,
+    __sc_counter,
+    NULL,
+    NULL,
+    };
+
+/**
+ * __sc_check - run the steps on a simulated timer
+ * @type:  the timer simulated
+ * @steps: number of steps
+ * @seed:  seed of the steps
+ *
+ * return: 0 if the clock is right, 1 if not
+ */
+
+static int __sc_check (const struct sc_timer * type, uint32_t steps,
+                       uint32_t seed)
+    {
+    uint64_t last = 0;
+    uint64_t now;
+    uint32_t pending;
+    uint32_t i;
+
+    sc_timer.name      = RTW_TICK_TIME_NAME;
+    sc_timer.down      = type->down;
+    sc_timer.free_run  = type->free_run;
+    sc_timer.freq      = RTW_SYS_TIMER_FREQ;
+    sc_timer.max_count = type->free_run ? SC_FREE_MAX : UINT32_MAX;
+    sc_timer.methods   = &sc_methods;
+
+    if ((hal_timer_register (&sc_timer) != 0) || (sysclk_init () != 0))
+        {
+        fprintf (stderr, "%s: sysclk_init failed\n", type->name);
+        return 1;
+        }
+
+    for (i = 0; i < steps; i++)
+        {
+        sc_now += __sc_rand (&seed) % (SYSCLK_CYCLES_PER_TICK / 3 + 1);
+
+        /* the tick isr of the free running timer may be late for a while */
+
+        pending = type->free_run ?
+                  __sc_rand (&seed) % (SYSCLK_CYCLES_PER_TICK / 2) : 0;
+
+        while (sc_now - sc_ticked >= SYSCLK_CYCLES_PER_TICK + pending)
+            {
+            sc_ticked += SYSCLK_CYCLES_PER_TICK;
+            sc_timer.handler (sc_timer.arg);
+            }
+
+        now = sysclk_cycles ();
+
+        if ((now < last) || (now != sc_now))
+            {
+            fprintf (stderr, "%s: step %u, read %llu after %llu, expected "
+                     "%llu\n", type->name, i, (unsigned long long) now,
+                     (unsigned long long) last, (unsigned long long) sc_now);
+            return 1;
+            }
+
+        last = now;
+        }
+
+    printf ("%-4s timer: %u steps, %llu cycles, monotonic\n", type->name,
+            steps, (unsigned long long) sc_now);
+
+    return 0;
+    }
+
+int main (int argc, char * argv [])
+    {
+    const char * timer = "all";
+    uint32_t     steps = SC_DEF_STEPS;
+    uint32_t     seed  = SC_DEF_SEED;
+    size_t       t;
+    pid_t        pid;
+    int          status;
+    int          opt;
+    int          ret   = 0;
+
+    while ((opt = getopt (argc, argv, "t:n:S:")) != -1)
+        {
+        switch (opt)
+            {
+            case 't': timer = optarg;                          break;
+            case 'n': steps = strtoul (optarg, NULL, 0);       break;
+            case 'S': seed  = strtoul (optarg, NULL, 0);       break;
+            default:
+                fprintf (stderr, "usage: %s [-t down|up|free|all] [-n steps] "
+                         "[-S seed]\n", argv [0]);
+                return 1;
+            }
+        }
+
+    if (seed == 0)
+        {
+        return 1;
+        }
+
+    for (t = 0; t < ARRAY_SIZE (sc_timers); t++)
+        {
+        if (strcmp (timer, "all") && strcmp (timer, sc_timers [t].name))
+            {
+            continue;
+            }
+
+        fflush (stdout);
+
+        if ((pid = fork ()) == 0)
+            {
+            exit (__sc_check (&sc_timers [t], steps, seed));
+            }
+
+        if ((pid < 0) || (waitpid (pid, &status, 0) != pid) ||
+            !WIFEXITED (status) || (WEXITSTATUS (status) != 0))
+            {
+            ret = 1;
+            }
+        }
+
+    return ret;
+    }
@@ -0,0 +1,261 @@
+/* timercheck.c - host check of the timer expiries */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+core/kernel/timer.c and core/kernel/tick.c are built natively on the host with
+the few kernel services they use stubbed out, the ticks are shot one by one and
+the callbacks of the timers are counted:
+
+    timercheck [-n ticks]
+
+    -n  number of ticks shot for each check (1000)
+
+checks:
+
+    init      one-shot and repeated timers set up with timer_init
+    create    one-shot and repeated timers got from timer_create, they carry
+              TIMER_FLAG_MALLOC, a repeated one must keep firing
+    restart   a repeated timer started again in the middle of a period
+
+a one-shot timer must fire exactly once, a repeated timer of interval <i> must
+fire <ticks> / <i> times, with no overrun.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <wheel/common.h>
+
+#include <kernel/task.h>
+#include <kernel/tick.h>
+#include <kernel/timer.h>
+#include <kernel/critical.h>
+#include <kernel/select.h>
+#include <kernel/pool.h>
+
+/* defines */
+
+#define TC_DEF_TICKS            1000
+#define TC_INTERVAL             7
+
+/* locals */
+
+static task_t       tc_task;
+
+/* host stubs of the kernel services used by timer.c and tick.c */
+
+task_id      current       = &tc_task;
+unsigned int task_lock_cnt = 0;
+
+int do_critical (int (* job) (uintptr_t, uintptr_t), uintptr_t arg1,
+                 uintptr_t arg2)
+    {
+    return job (arg1, arg2);
+    }
+
+int do_critical_non_irq (int (* job) (uintptr_t, uintptr_t), uintptr_t arg1,
+                         uintptr_t arg2)
+    {
+    return job (arg1, arg2);
+    }
+
+void task_ready_q_add (struct task * task)
+    {
+    (void) task;
+    }
+
+void task_ready_q_del (struct task * task)
+    {
+    (void) task;
+    }
+
+void kobj_sel_notify (dlist_t * sel_q)
+    {
+    (void) sel_q;
+    }
+
+void * pool_alloc (pool_id pool)
+    {
+    (void) pool;
+
+    return NULL;
+    }
+
+int pool_free (pool_id pool, void * blk)
+    {
+    (void) pool;
+    (void) blk;
+
+    return -1;
+    }
+
+static void __tc_callback (uintptr_t arg)
+    {
+    (*(unsigned int *) arg)++;
+    }
+
+static void __tc_shot (unsigned int ticks)
+    {
+    while (ticks--)
+        {
+        tick_shot ();
+        }
+    }
+
+/**
+ * __tc_expect - check the number of callbacks and the overruns of a timer
+ * @name:  the name of the check
+ * @timer: the timer
+ * @fired: the number of callbacks run
+ * @want:  the number of callbacks expected
+ *
+ * return: 0 if right, 1 if not
+ */
+
+static int __tc_expect (const char * name, timer_id timer, unsigned int fired,
+                        unsigned int want)
+    {
+    bool ok = (fired == want) && (timer->expired == want) &&
+              (timer->overruns == 0);
+
+    printf ("%-18s fired %5u, expected %5u, overruns %u, %s\n", name, fired,
+            want, (unsigned int) timer->overruns, ok ? "ok" : "FAILED");
+
+    return ok ? 0 : 1;
+    }
+
+static int __tc_init (unsigned int ticks)
+    {
+    timer_t      once;
+    timer_t      rept;
+    unsigned int once_fired = 0;
+    unsigned int rept_fired = 0;
+    int          ret        = 0;
+
+    if ((timer_init (&once, TIMER_FLAG_ONE_SHOT, TC_INTERVAL, 0,
+                     __tc_callback, (uintptr_t) &once_fired) != 0) ||
+        (timer_init (&rept, TIMER_FLAG_REPEATED, TC_INTERVAL, 0,
+                     __tc_callback, (uintptr_t) &rept_fired) != 0))
+        {
+        return 1;
+        }
+
+    (void) timer_start (&once);
+    (void) timer_start (&rept);
+
+    __tc_shot (ticks);
+
+    ret |= __tc_expect ("init one-shot", &once, once_fired, 1);
+    ret |= __tc_expect ("init repeated", &rept, rept_fired,
+                        ticks / TC_INTERVAL);
+
+    (void) timer_stop (&rept);
+
+    return ret;
+    }
+
+static int __tc_create (unsigned int ticks)
+    {
+    timer_id     once;
+    timer_id     rept;
+    unsigned int once_fired = 0;
+    unsigned int rept_fired = 0;
+    int          ret        = 0;
+
+    once = timer_create (TIMER_FLAG_ONE_SHOT, TC_INTERVAL, 0, __tc_callback,
+                         (uintptr_t) &once_fired);
+    rept = timer_create (TIMER_FLAG_REPEATED, TC_INTERVAL, 0, __tc_callback,
+                         (uintptr_t) &rept_fired);
+
+    if ((once == NULL) || (rept == NULL))
+        {
+        return 1;
+        }
+
+    (void) timer_start (once);
+    (void) timer_start (rept);
+
+    __tc_shot (ticks);
+
+    ret |= __tc_expect ("create one-shot", once, once_fired, 1);
+    ret |= __tc_expect ("create repeated", rept, rept_fired,
+                        ticks / TC_INTERVAL);
+
+    (void) timer_delete (once);
+    (void) timer_delete (rept);
+
+    return ret;
+    }
+
+static int __tc_restart (unsigned int ticks)
+    {
+    timer_id     rept;
+    unsigned int rept_fired = 0;
+    int          ret;
+
+    rept = timer_create (TIMER_FLAG_REPEATED, TC_INTERVAL, 0, __tc_callback,
+                         (uintptr_t) &rept_fired);
+
+    if (rept == NULL)
+        {
+        return 1;
+        }
+
+    /* restarted in the middle of the first period, the periods count again */
+
+    (void) timer_start (rept);
+
+    __tc_shot (TC_INTERVAL / 2);
+
+    (void) timer_start (rept);
+
+    __tc_shot (ticks);
+
+    ret = __tc_expect ("create restarted", rept, rept_fired,
+                       ticks / TC_INTERVAL);
+
+    (void) timer_delete (rept);
+
+    return ret;
+    }
+
+int main (int argc, char * argv [])
+    {
+    unsigned int ticks = TC_DEF_TICKS;
+    int          opt;
+    int          ret   = 0;
+
+    while ((opt = getopt (argc, argv, "n:")) != -1)
+        {
+        switch (opt)
+            {
+            case 'n': ticks = strtoul (optarg, NULL, 0);       break;
+            default:
+                fprintf (stderr, "usage: %s [-n ticks]\n", argv [0]);
+                return 1;
+            }
+        }
+
+    if (ticks < TC_INTERVAL * 2)
+        {
+        return 1;
+        }
+
+    ret |= __tc_init (ticks);
+    ret |= __tc_create (ticks);
+    ret |= __tc_restart (ticks);
+
+    return ret;
+    }
@@ -0,0 +1,1223 @@
+/* treebench.c - host benchmark of the avl tree and the red black trees */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+utils/avltree.c, utils/rbtree.c and utils/crbtree.c are built natively on the
+host, for each tree size (1k to 1M nodes by default) all the trees are filled
+with the same random keys and then measured with the same sequences of
+operations:
+
+    insert    building the tree
+    find_eq   looking up keys in the tree
+    find_ge   looking up random keys, mostly not in the tree
+    update    deleting a node and inserting it back with a new key
+
+the average cost per operation and the height of the trees are reported.
+
+before that, the verify mode runs every tree (and a crb tree augmented with the
+node count of each sub tree) through random inserts and deletes, and checks it
+against a sorted array of the keys after the operations:
+
+    - the invariants, the parent links and the in order keys of the tree, the
+      balance and the heights of the avl tree, the colors and the black heights
+      of the red black trees, the cached first node and the augmented counts
+    - first/next and last/prev walk all the keys in order
+    - find_eq, find_ge, find_gt, find_le and find_lt on every key in the tree
+      and every key between them, out of the range too
+
+the nodes are deleted at random, so many of them have two children.
+
+    treebench [-m verify|bench|all] [-n max_nodes] [-l lookups] [-S seed]
+*/
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <wheel/avltree.h>
+#include <wheel/rbtree.h>
+#include <wheel/crbtree.h>
+
+/* defines */
+
+#define TB_DEF_NODES            1000000
+#define TB_DEF_LOOKUPS          1000000
+#define TB_DEF_SEED             0x9e3779b9u
+
+/* typedefs */
+
+struct tb_avl
+    {
+    avl_node_t node;
+    uintptr_t  key;
+    };
+
+struct tb_rb
+    {
+    rb_node_t  node;
+    uintptr_t  key;
+    };
+
+struct tb_crb
+    {
+    crb_node_t node;
+    uintptr_t  key;
+    };
+
+struct tb_result
+    {
+    double     insert;      /* ns per operation */
+    double     find_eq;
+    double     find_ge;
+    double     update;
+    int        height;
+    };
+
+/* locals */
+
+static uint32_t tb_seed = TB_DEF_SEED;
+
+static inline uint32_t __tb_rand (void)
+    {
+    tb_seed ^= tb_seed << 13;
+    tb_seed ^= tb_seed >> 17;
+    tb_seed ^= tb_seed << 5;
+
+    return tb_seed;
+    }
+
+static inline uint64_t __tb_ns (void)
+    {
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    }
+
+static int __tb_height (bi_node_t * n)
+    {
+    int l, r;
+
+    if (n == NULL)
+        {
+        return 0;
+        }
+
+    l = __tb_height (n->l);
+    r = __tb_height (n->r);
+
+    return (l > r ? l : r) + 1;
+    }
+
+static int __tb_crb_height (crb_node_t * n)
+    {
+    int l, r;
+
+    if (n == NULL)
+        {
+        return 0;
+        }
+
+    l = __tb_crb_height (n->l);
+    r = __tb_crb_height (n->r);
+
+    return (l > r ? l : r) + 1;
+    }
+
+static int __avl_compare_nk (bi_node_t * n, uintptr_t k)
+    {
+    uintptr_t nk = container_of (n, struct tb_avl, node.bin)->key;
+
+    return nk < k ? -1 : nk > k;
+    }
+
+static int __avl_compare_nn (bi_node_t * a, bi_node_t * b)
+    {
+    return __avl_compare_nk (a, container_of (b, struct tb_avl, node.bin)->key);
+    }
+
+static int __rb_compare_nk (bi_node_t * n, uintptr_t k)
+    {
+    uintptr_t nk = container_of (n, struct tb_rb, node.bin)->key;
+
+    return nk < k ? -1 : nk > k;
+    }
+
+static int __rb_compare_nn (bi_node_t * a, bi_node_t * b)
+    {
+    return __rb_compare_nk (a, container_of (b, struct tb_rb, node.bin)->key);
+    }
+
+CRB_GENERATE (__tb_crb_tree, struct tb_crb, node, uintptr_t, key, CRB_CMP_NUM,
+              NULL)
+
+/*
+ * the runners are the same but the tree type, they are written out instead of
+ * a macro to keep them readable
+ */
+
+static void __tb_avl (uintptr_t * keys, uint32_t * probes, size_t nr,
+                      size_t lookups, struct tb_result * res)
+    {
+    struct tb_avl * nodes = malloc (sizeof (struct tb_avl) * nr);
+    avl_tree_t      tree;
+    volatile void * sink;
+    uint64_t        t;
+    size_t          i;
+
+    avl_init (&tree, __avl_compare_nn, __avl_compare_nk);
+
+    t = __tb_ns ();
+    for (i = 0; i < nr; i++)
+        {
+        nodes [i].key = keys [i];
+        (void) avl_insert (&tree, &nodes [i].node);
+        }
+    res->insert = (double) (__tb_ns () - t) / nr;
+
+    t = __tb_ns ();
+    for (i = 0; i < lookups; i++)
+        {
+        sink = avl_find_eq (&tree, keys [probes [i] % nr]);
+        }
+    res->find_eq = (double) (__tb_ns () - t) / lookups;
+
+    t = __tb_ns ();
+    for (i = 0; i < lookups; i++)
+        {
+        sink = avl_find_ge (&tree, (uintptr_t) probes [i] << 1);
+        }
+    res->find_ge = (double) (__tb_ns () - t) / lookups;
+
+    /* the new keys are odd, moved on if already used by an earlier update */
+
+    t = __tb_ns ();
+    for (i = 0; i < lookups; i++)
+        {
+        struct tb_avl * n = &nodes [probes [i] % nr];
+
+        avl_delete (&tree, &n->node);
+        n->key = ((uintptr_t) probes [lookups - 1 - i] << 1) | 1;
+
+        while (avl_insert (&tree, &n->node) != 0)
+            {
+            n->key += 2;
+            }
+        }
+    res->update = (double) (__tb_ns () - t) / lookups;
+
+    res->height = __tb_height (tree.bit.r);
+
+    (void) sink;
+
+    free (nodes);
+    }
+
+static void __tb_rb (uintptr_t * keys, uint32_t * probes, size_t nr,
+                     size_t lookups, struct tb_result * res)
+    {
+    struct tb_rb  * nodes = malloc (sizeof (struct tb_rb) * nr);
+    rb_tree_t       tree;
+    volatile void * sink;
+    uint64_t        t;
+    size_t          i;
+
+    rb_init (&tree, __rb_compare_nn, __rb_compare_nk);
+
+    t = __tb_ns ();
+    for (i = 0; i < nr; i++)
+        {
+        nodes [i].key = keys [i];
+        (void) rb_insert (&tree, &nodes [i].node);
+        }
+    res->insert = (double) (__tb_ns () - t) / nr;
+
+    t = __tb_ns ();
+    for (i = 0; i < lookups; i++)
+        {
+        sink = rb_find_eq (&tree, keys [probes [i] % nr]);
+        }
+    res->find_eq = (double) (__tb_ns () - t) / lookups;
+
+    t = __tb_ns ();
+    for (i = 0; i < lookups; i++)
+        {
+        sink = rb_find_ge (&tree, (uintptr_t) probes [i] << 1);
+        }
+    res->find_ge = (double) (__tb_ns () - t) / lookups;
+
+    t = __tb_ns ();
+    for (i = 0; i < lookups; i++)
+        {
+        struct tb_rb * n = &nodes [probes [i] % nr];
+
+        rb_delete (&tree, &n->node);
+        n->key = ((uintptr_t) probes [lookups - 1 - i] << 1) | 1;
+
+        while (rb_insert (&tree, &n->node) != 0)
+            {
+            n->key += 2;
+            }
+        }
+    res->update = (double) (__tb_ns () - t) / lookups;
+
+    res->height = __tb_height (tree.bit.r);
+
+    (void) sink;
+
+    free (nodes);
+    }
+
+static void __tb_crb (uintptr_t * keys, uint32_t * probes, size_t nr,
+                      size_t lookups, struct tb_result * res)
+    {
+    struct tb_crb * nodes = malloc (sizeof (struct tb_crb) * nr);
+    crb_root_t      tree  = CRB_ROOT_INIT;
+    volatile void * sink;
+    uint64_t        t;
+    size_t          i;
+
+    t = __tb_ns ();
+    for (i = 0; i < nr; i++)
+        {
+        nodes [i].key = keys [i];
+        (void) __tb_crb_tree_insert (&tree, &nodes [i]);
+        }
+    res->insert = (double) (__tb_ns () - t) / nr;
+
+    t = __tb_ns ();
+    for (i = 0; i < lookups; i++)
+        {
+        sink = __tb_crb_tree_find_eq (&tree, keys [probes [i] % nr]);
+        }
+    res->find_eq = (double) (__tb_ns () - t) / lookups;
+
+    t = __tb_ns ();
+    for (i = 0; i < lookups; i++)
+        {
+        sink = __tb_crb_tree_find_ge (&tree, (uintptr_t) probes [i] << 1);
+        }
+    res->find_ge = (double) (__tb_ns () - t) / lookups;
+
+    t = __tb_ns ();
+    for (i = 0; i < lookups; i++)
+        {
+        struct tb_crb * n = &nodes [probes [i] % nr];
+
+        __tb_crb_tree_delete (&tree, n);
+        n->key = ((uintptr_t) probes [lookups - 1 - i] << 1) | 1;
+
+        while (__tb_crb_tree_insert (&tree, n) != NULL)
+            {
+            n->key += 2;
+            }
+        }
+    res->update = (double) (__tb_ns () - t) / lookups;
+
+    res->height = __tb_crb_height (tree.r);
+
+    (void) sink;
+
+    free (nodes);
+    }
+
+/*
+ * the verify mode, every tree is run through random inserts and deletes and
+ * checked against a sorted array of the keys in it (the oracle), see
+ * __tb_verify_check for what is checked
+ */
+
+enum { TB_EQ, TB_GE, TB_GT, TB_LE, TB_LT, TB_NR_FINDS };
+
+struct tb_oracle
+    {
+    uintptr_t      * keys;      /* sorted */
+    size_t           nr;
+    };
+
+struct tb_walk
+    {
+    struct tb_oracle * o;
+    size_t           i;         /* nodes met in order */
+    bool             aug;       /* check the sub tree counts of tb_acrb */
+    const char     * err;
+    };
+
+/* the plain crb routines work on a tb_acrb as <crb> is the first member */
+
+struct tb_acrb
+    {
+    struct tb_crb    crb;
+    size_t           count;     /* nodes of the sub tree, the augmented data */
+    };
+
+union tb_tree
+    {
+    avl_tree_t       avl;
+    rb_tree_t        rb;
+    crb_root_t       crb;
+    };
+
+struct tb_ops
+    {
+    const char     * name;
+    size_t           size;      /* size of the node struct */
+    void          (* init)   (void * t);
+    bool          (* insert) (void * t, void * n);  /* false if duplicated */
+    void          (* delete) (void * t, void * n);
+    void *        (* find)   (void * t, int xx, uintptr_t k);
+    void *        (* first)  (void * t);
+    void *        (* last)   (void * t);
+    void *        (* next)   (void * n);
+    void *        (* prev)   (void * n);
+    bool          (* full)   (void * n);            /* has two children */
+    uintptr_t *   (* key)    (void * n);
+    const char *  (* check)  (void * t, struct tb_oracle * o);
+    };
+
+static const char * tb_finds [TB_NR_FINDS] = { "eq", "ge", "gt", "le", "lt" };
+
+static char tb_err [64];
+
+static size_t __tb_bound (struct tb_oracle * o, uintptr_t k, bool upper)
+    {
+    size_t lo = 0;
+    size_t hi = o->nr;
+    size_t mid;
+
+    while (lo < hi)
+        {
+        mid = (lo + hi) / 2;
+
+        if ((o->keys [mid] < k) || (upper && (o->keys [mid] == k)))
+            {
+            lo = mid + 1;
+            }
+        else
+            {
+            hi = mid;
+            }
+        }
+
+    return lo;
+    }
+
+static bool __tb_oracle_find (struct tb_oracle * o, int xx, uintptr_t k,
+                              uintptr_t * key)
+    {
+    size_t ge = __tb_bound (o, k, false);   /* the first key >= k */
+    size_t gt = __tb_bound (o, k, true);    /* the first key > k */
+    size_t i;
+
+    switch (xx)
+        {
+        case TB_EQ: if (ge == gt)    return false; i = ge;     break;
+        case TB_GE: if (ge == o->nr) return false; i = ge;     break;
+        case TB_GT: if (gt == o->nr) return false; i = gt;     break;
+        case TB_LE: if (gt == 0)     return false; i = gt - 1; break;
+        default:    if (ge == 0)     return false; i = ge - 1; break;
+        }
+
+    *key = o->keys [i];
+
+    return true;
+    }
+
+static bool __tb_oracle_insert (struct tb_oracle * o, uintptr_t k)
+    {
+    size_t i = __tb_bound (o, k, false);
+
+    if ((i < o->nr) && (o->keys [i] == k))
+        {
+        return false;
+        }
+
+    memmove (&o->keys [i + 1], &o->keys [i], (o->nr - i) * sizeof (uintptr_t));
+
+    o->keys [i] = k;
+    o->nr++;
+
+    return true;
+    }
+
+static void __tb_oracle_delete (struct tb_oracle * o, uintptr_t k)
+    {
+    size_t i = __tb_bound (o, k, false);
+
+    o->nr--;
+
+    memmove (&o->keys [i], &o->keys [i + 1], (o->nr - i) * sizeof (uintptr_t));
+    }
+
+static int __tb_fail (struct tb_walk * w, const char * err)
+    {
+    w->err = err;
+
+    return -1;
+    }
+
+static bool __tb_walk_key (struct tb_walk * w, uintptr_t key)
+    {
+    return (w->i < w->o->nr) && (w->o->keys [w->i++] == key);
+    }
+
+/**
+ * __tb_avl_check - check an avl sub tree, the parent links, the order of the
+ *                  keys, the balance and the recorded heights
+ *
+ * return: the height of the sub tree, -1 on error
+ */
+
+static int __tb_avl_check (bi_node_t * n, bi_node_t * p, struct tb_walk * w)
+    {
+    struct tb_avl * e;
+    int             l;
+    int             r;
+    int             h;
+
+    if (n == NULL)
+        {
+        return 0;
+        }
+
+    e = container_of (n, struct tb_avl, node.bin);
+
+    if (n->p != p)
+        {
+        return __tb_fail (w, "bad parent");
+        }
+
+    if ((l = __tb_avl_check (n->l, n, w)) < 0)
+        {
+        return -1;
+        }
+
+    if (!__tb_walk_key (w, e->key))
+        {
+        return __tb_fail (w, "bad order");
+        }
+
+    if ((r = __tb_avl_check (n->r, n, w)) < 0)
+        {
+        return -1;
+        }
+
+    if ((l - r > 1) || (r - l > 1))
+        {
+        return __tb_fail (w, "unbalanced");
+        }
+
+    h = (l > r ? l : r) + 1;
+
+    if (e->node.height != h)
+        {
+        return __tb_fail (w, "bad height");
+        }
+
+    return h;
+    }
+
+/**
+ * __tb_rb_check - check a red black sub tree, the parent links, the order of
+ *                 the keys, no red node has a red child and the black heights
+ *
+ * return: the black height of the sub tree, -1 on error
+ */
+
+static int __tb_rb_check (bi_node_t * n, bi_node_t * p, struct tb_walk * w)
+    {
+    struct tb_rb * e;
+    int            l;
+    int            r;
+
+    if (n == NULL)
+        {
+        return 0;
+        }
+
+    e = container_of (n, struct tb_rb, node.bin);
+
+    if (n->p != p)
+        {
+        return __tb_fail (w, "bad parent");
+        }
+
+    if ((l = __tb_rb_check (n->l, n, w)) < 0)
+        {
+        return -1;
+        }
+
+    if (!__tb_walk_key (w, e->key))
+        {
+        return __tb_fail (w, "bad order");
+        }
+
+    if ((r = __tb_rb_check (n->r, n, w)) < 0)
+        {
+        return -1;
+        }
+
+    if ((e->node.c == RBTREE_RED) &&
+        (((n->l != NULL) &&
+          (container_of (n->l, rb_node_t, bin)->c == RBTREE_RED)) ||
+         ((n->r != NULL) &&
+          (container_of (n->r, rb_node_t, bin)->c == RBTREE_RED))))
+        {
+        return __tb_fail (w, "red node with red child");
+        }
+
+    if (l != r)
+        {
+        return __tb_fail (w, "bad black height");
+        }
+
+    return l + (e->node.c == RBTREE_BLACK);
+    }
+
+/**
+ * __tb_crb_check - check a compact red black sub tree, as __tb_rb_check, and
+ *                  the sub tree counts if <w->aug>
+ * @size: return the number of nodes of the sub tree
+ *
+ * return: the black height of the sub tree, -1 on error
+ */
+
+static int __tb_crb_check (crb_node_t * n, crb_node_t * p, struct tb_walk * w,
+                           size_t * size)
+    {
+    struct tb_crb * e;
+    size_t          ls;
+    size_t          rs;
+    int             l;
+    int             r;
+
+    *size = 0;
+
+    if (n == NULL)
+        {
+        return 0;
+        }
+
+    e = container_of (n, struct tb_crb, node);
+
+    if (crb_parent (n) != p)
+        {
+        return __tb_fail (w, "bad parent");
+        }
+
+    if ((l = __tb_crb_check (n->l, n, w, &ls)) < 0)
+        {
+        return -1;
+        }
+
+    if (!__tb_walk_key (w, e->key))
+        {
+        return __tb_fail (w, "bad order");
+        }
+
+    if ((r = __tb_crb_check (n->r, n, w, &rs)) < 0)
+        {
+        return -1;
+        }
+
+    if (((n->pc & 1) == CRBTREE_RED) &&
+        (((n->l != NULL) && ((n->l->pc & 1) == CRBTREE_RED)) ||
+         ((n->r != NULL) && ((n->r->pc & 1) == CRBTREE_RED))))
+        {
+        return __tb_fail (w, "red node with red child");
+        }
+
+    if (l != r)
+        {
+        return __tb_fail (w, "bad black height");
+        }
+
+    *size = ls + rs + 1;
+
+    if (w->aug && (container_of (e, struct tb_acrb, crb)->count != *size))
+        {
+        return __tb_fail (w, "bad augmented count");
+        }
+
+    return l + ((n->pc & 1) == CRBTREE_BLACK);
+    }
+
+static const char * __tb_avl_verify (void * t, struct tb_oracle * o)
+    {
+    struct tb_walk w = { o, 0, false, NULL };
+
+    if (__tb_avl_check (((avl_tree_t *) t)->bit.r, NULL, &w) < 0)
+        {
+        return w.err;
+        }
+
+    return w.i == o->nr ? NULL : "nodes lost";
+    }
+
+static const char * __tb_rb_verify (void * t, struct tb_oracle * o)
+    {
+    rb_tree_t    * tree = (rb_tree_t *) t;
+    bi_node_t    * r    = tree->bit.r;
+    struct tb_walk w    = { o, 0, false, NULL };
+
+    if ((r != NULL) && (container_of (r, rb_node_t, bin)->c != RBTREE_BLACK))
+        {
+        return "red root";
+        }
+
+    if (__tb_rb_check (r, NULL, &w) < 0)
+        {
+        return w.err;
+        }
+
+    if (tree->nodes != o->nr)
+        {
+        return "bad node count";
+        }
+
+    return w.i == o->nr ? NULL : "nodes lost";
+    }
+
+static const char * __tb_crb_verify_x (void * t, struct tb_oracle * o, bool aug)
+    {
+    crb_root_t   * tree = (crb_root_t *) t;
+    crb_node_t   * n    = tree->r;
+    struct tb_walk w    = { o, 0, aug, NULL };
+    size_t         size;
+
+    if ((n != NULL) && ((n->pc & 1) != CRBTREE_BLACK))
+        {
+        return "red root";
+        }
+
+    if (__tb_crb_check (n, NULL, &w, &size) < 0)
+        {
+        return w.err;
+        }
+
+    while ((n != NULL) && (n->l != NULL))
+        {
+        n = n->l;
+        }
+
+    if (tree->first != n)
+        {
+        return "bad cached first";
+        }
+
+    return w.i == o->nr ? NULL : "nodes lost";
+    }
+
+static const char * __tb_crb_verify (void * t, struct tb_oracle * o)
+    {
+    return __tb_crb_verify_x (t, o, false);
+    }
+
+static const char * __tb_acrb_verify (void * t, struct tb_oracle * o)
+    {
+    return __tb_crb_verify_x (t, o, true);
+    }
+
+/*
+ * TB_BIT_OPS - generate the verify adapters of the avl tree or the rb tree,
+ * they are the same but the names
+ */
+
+#define TB_BIT_OPS(x)                                                       \
+static void __tb_##x##_init (void * t)                                      \
+    {                                                                       \
+    x##_init ((x##_tree_t *) t, __##x##_compare_nn, __##x##_compare_nk);    \
+    }                                                                       \
+                                                                            \
+static bool __tb_##x##_insert (void * t, void * n)                          \
+    {                                                                       \
+    struct tb_##x * e = (struct tb_##x *) n;                                \
+                                                                            \
+    return x##_insert ((x##_tree_t *) t, &e->node) == 0;                    \
+    }                                                                       \
+                                                                            \
+static void __tb_##x##_delete (void * t, void * n)                          \
+    {                                                                       \
+    x##_delete ((x##_tree_t *) t, &((struct tb_##x *) n)->node);            \
+    }                                                                       \
+                                                                            \
+static void * __tb_##x##_entry (x##_node_t * n)                             \
+    {                                                                       \
+    return n == NULL ? NULL : container_of (n, struct tb_##x, node);        \
+    }                                                                       \
+                                                                            \
+static void * __tb_##x##_find (void * t, int xx, uintptr_t k)               \
+    {                                                                       \
+    static x##_node_t * (* finds [TB_NR_FINDS]) (x##_tree_t *, uintptr_t) = \
+        {                                                                   \
+        x##_find_eq, x##_find_ge, x##_find_gt, x##_find_le, x##_find_lt     \
+        };                                                                  \
+                                                                            \
+    return __tb_##x##_entry (finds [xx] ((x##_tree_t *) t, k));             \
+    }                                                                       \
+                                                                            \
+static void * __tb_##x##_first (void * t)                                   \
+    {                                                                       \
+    return __tb_##x##_entry (x##_first ((x##_tree_t *) t));                 \
+    }                                                                       \
+                                                                            \
+static void * __tb_##x##_last (void * t)                                    \
+    {                                                                       \
+    return __tb_##x##_entry (x##_last ((x##_tree_t *) t));                  \
+    }                                                                       \
+                                                                            \
+static void * __tb_##x##_next (void * n)                                    \
+    {                                                                       \
+    return __tb_##x##_entry (x##_next (&((struct tb_##x *) n)->node));      \
+    }                                                                       \
+                                                                            \
+static void * __tb_##x##_prev (void * n)                                    \
+    {                                                                       \
+    return __tb_##x##_entry (x##_prev (&((struct tb_##x *) n)->node));      \
+    }                                                                       \
+                                                                            \
+static bool __tb_##x##_full (void * n)                                      \
+    {                                                                       \
+    bi_node_t * b = &((struct tb_##x *) n)->node.bin;                       \
+                                                                            \
+    return (b->l != NULL) && (b->r != NULL);                                \
+    }                                                                       \
+                                                                            \
+static uintptr_t * __tb_##x##_key (void * n)                                \
+    {                                                                       \
+    return &((struct tb_##x *) n)->key;                                     \
+    }
+
+TB_BIT_OPS (avl)
+TB_BIT_OPS (rb)
+
+static inline size_t __tb_acrb_count (crb_node_t * n)
+    {
+    return n == NULL ? 0 : container_of (n, struct tb_acrb, crb.node)->count;
+    }
+
+static bool __tb_acrb_update (crb_node_t * n)
+    {
+    struct tb_acrb * e     = container_of (n, struct tb_acrb, crb.node);
+    size_t           count = __tb_acrb_count (n->l) + __tb_acrb_count (n->r) + 1;
+
+    if (e->count == count)
+        {
+        return false;
+        }
+
+    e->count = count;
+
+    return true;
+    }
+
+static const crb_augment_t tb_acrb_aug = { __tb_acrb_update };
+
+CRB_GENERATE (__tb_acrb_tree, struct tb_acrb, crb.node, uintptr_t, crb.key,
+              CRB_CMP_NUM, &tb_acrb_aug)
+
+static void __tb_crb_init (void * t)
+    {
+    crb_init ((crb_root_t *) t);
+    }
+
+static bool __tb_crb_insert (void * t, void * n)
+    {
+    return __tb_crb_tree_insert ((crb_root_t *) t, (struct tb_crb *) n) == NULL;
+    }
+
+static void __tb_crb_delete (void * t, void * n)
+    {
+    __tb_crb_tree_delete ((crb_root_t *) t, (struct tb_crb *) n);
+    }
+
+static bool __tb_acrb_insert (void * t, void * n)
+    {
+    return __tb_acrb_tree_insert ((crb_root_t *) t, (struct tb_acrb *) n) ==
+           NULL;
+    }
+
+static void __tb_acrb_delete (void * t, void * n)
+    {
+    __tb_acrb_tree_delete ((crb_root_t *) t, (struct tb_acrb *) n);
+    }
+
+static void * __tb_crb_find (void * t, int xx, uintptr_t k)
+    {
+    crb_root_t * tree = (crb_root_t *) t;
+
+    switch (xx)
+        {
+        case TB_EQ: return __tb_crb_tree_find_eq (tree, k);
+        case TB_GE: return __tb_crb_tree_find_ge (tree, k);
+        case TB_GT: return __tb_crb_tree_find_gt (tree, k);
+        case TB_LE: return __tb_crb_tree_find_le (tree, k);
+        default:    return __tb_crb_tree_find_lt (tree, k);
+        }
+    }
+
+static void * __tb_crb_first (void * t)
+    {
+    return __tb_crb_tree_first ((crb_root_t *) t);
+    }
+
+static void * __tb_crb_last (void * t)
+    {
+    return __tb_crb_tree_last ((crb_root_t *) t);
+    }
+
+static void * __tb_crb_next (void * n)
+    {
+    return __tb_crb_tree_next ((struct tb_crb *) n);
+    }
+
+static void * __tb_crb_prev (void * n)
+    {
+    return __tb_crb_tree_prev ((struct tb_crb *) n);
+    }
+
+static bool __tb_crb_full (void * n)
+    {
+    crb_node_t * c = &((struct tb_crb *) n)->node;
+
+    return (c->l != NULL) && (c->r != NULL);
+    }
+
+static uintptr_t * __tb_crb_key (void * n)
+    {
+    return &((struct tb_crb *) n)->key;
+    }
+
+static const struct tb_ops tb_ops [] =
+    {
+        {
+        "avl", sizeof (struct tb_avl), __tb_avl_init, __tb_avl_insert,
+        __tb_avl_delete, __tb_avl_find, __tb_avl_first, __tb_avl_last,
+        __tb_avl_next, __tb_avl_prev, __tb_avl_full, __tb_avl_key,
+        __tb_avl_verify
+        },
+        {
+        "rb", sizeof (struct tb_rb), __tb_rb_init, __tb_rb_insert,
+        __tb_rb_delete, __tb_rb_find, __tb_rb_first, __tb_rb_last,
+        __tb_rb_next, __tb_rb_prev, __tb_rb_full, __tb_rb_key,
+        __tb_rb_verify
+        },
+        {
+        "crb", sizeof (struct tb_crb), __tb_crb_init, __tb_crb_insert,
+        __tb_crb_delete, __tb_crb_find, __tb_crb_first, __tb_crb_last,
+        __tb_crb_next, __tb_crb_prev, __tb_crb_full, __tb_crb_key,
+        __tb_crb_verify
+        },
+        {
+        "acrb", sizeof (struct tb_acrb), __tb_crb_init, __tb_acrb_insert,
+        __tb_acrb_delete, __tb_crb_find, __tb_crb_first, __tb_crb_last,
+        __tb_crb_next, __tb_crb_prev, __tb_crb_full, __tb_crb_key,
+        __tb_acrb_verify
+        },
+    };
+
+/**
+ * __tb_verify_check - check a tree against the oracle, the invariants of the
+ *                     tree, the walks with first/next and last/prev, and all
+ *                     the finds on every key up to <kmax>
+ *
+ * return: NULL if the tree is right, or what is wrong
+ */
+
+static const char * __tb_verify_check (const struct tb_ops * ops, void * t,
+                                       struct tb_oracle * o, uintptr_t kmax)
+    {
+    const char * err;
+    void       * n;
+    uintptr_t    key;
+    uintptr_t    k;
+    size_t       i;
+    bool         has;
+    int          xx;
+
+    if ((err = ops->check (t, o)) != NULL)
+        {
+        return err;
+        }
+
+    for (i = 0, n = ops->first (t); n != NULL; n = ops->next (n), i++)
+        {
+        if ((i >= o->nr) || (*ops->key (n) != o->keys [i]))
+            {
+            return "bad first/next walk";
+            }
+        }
+
+    if (i != o->nr)
+        {
+        return "bad first/next walk";
+        }
+
+    for (i = o->nr, n = ops->last (t); n != NULL; n = ops->prev (n))
+        {
+        if ((i == 0) || (*ops->key (n) != o->keys [--i]))
+            {
+            return "bad last/prev walk";
+            }
+        }
+
+    if (i != 0)
+        {
+        return "bad last/prev walk";
+        }
+
+    /* the keys in the tree are even, so the odd ones fall between them */
+
+    for (k = 0; k <= kmax; k++)
+        {
+        for (xx = 0; xx < TB_NR_FINDS; xx++)
+            {
+            n   = ops->find (t, xx, k);
+            has = __tb_oracle_find (o, xx, k, &key);
+
+            if ((has != (n != NULL)) || (has && (*ops->key (n) != key)))
+                {
+                snprintf (tb_err, sizeof (tb_err), "bad find_%s (%lu)",
+                          tb_finds [xx], (unsigned long) k);
+                return tb_err;
+                }
+            }
+        }
+
+    return NULL;
+    }
+
+/**
+ * __tb_verify - verify a tree with <nr> nodes, the nodes are inserted first,
+ *               then <rounds> random nodes are deleted or inserted back with a
+ *               new key, the tree is checked after every operation for small
+ *               trees, or 16 times per <nr> operations for the others
+ *
+ * return: 0 if all the checks passed, 1 if not
+ */
+
+static int __tb_verify (const struct tb_ops * ops, size_t nr, size_t rounds)
+    {
+    char           * nodes = calloc (nr, ops->size);
+    bool           * in    = calloc (nr, sizeof (bool));
+    uintptr_t        kmax  = (uintptr_t) nr * 4 + 3;
+    size_t           step  = nr <= 64 ? 1 : nr / 16;
+    size_t           fulls = 0;     /* deletes of the nodes with two children */
+    const char     * err   = NULL;
+    struct tb_oracle o;
+    union tb_tree    tree;
+    uintptr_t        k;
+    void           * n;
+    size_t           i;
+    size_t           s;
+
+    o.keys = malloc (sizeof (uintptr_t) * nr);
+    o.nr   = 0;
+
+    if ((nodes == NULL) || (in == NULL) || (o.keys == NULL))
+        {
+        return 1;
+        }
+
+    ops->init (&tree);
+
+    for (i = 0; (err == NULL) && (i < nr + rounds); i++)
+        {
+        s = i < nr ? i : __tb_rand () % nr;
+        n = nodes + s * ops->size;
+
+        if (in [s])
+            {
+            fulls += ops->full (n);
+
+            ops->delete (&tree, n);
+
+            __tb_oracle_delete (&o, *ops->key (n));
+
+            in [s] = false;
+            }
+        else
+            {
+
+            /* even keys in [2, nr * 4], half of them are in the tree at most */
+
+            k = ((uintptr_t) (__tb_rand () % (nr * 2)) + 1) * 2;
+
+            *ops->key (n) = k;
+
+            in [s] = __tb_oracle_insert (&o, k);
+
+            if (ops->insert (&tree, n) != in [s])
+                {
+                err = "bad insert";
+                }
+            }
+
+        if ((err == NULL) && ((i % step == 0) || (i == nr + rounds - 1)))
+            {
+            err = __tb_verify_check (ops, &tree, &o, kmax);
+            }
+        }
+
+    if ((err == NULL) && (nr >= 64) && (fulls == 0))
+        {
+        err = "no node with two children deleted";
+        }
+
+    if (err != NULL)
+        {
+        printf ("verify %5s %8u nodes: FAILED at operation %u, %s\n",
+                ops->name, (unsigned int) nr, (unsigned int) i, err);
+        }
+    else
+        {
+        printf ("verify %5s %8u nodes: %u operations, %u deletes with two "
+                "children, ok\n", ops->name, (unsigned int) nr,
+                (unsigned int) i, (unsigned int) fulls);
+        }
+
+    free (o.keys);
+    free (in);
+    free (nodes);
+
+    return err != NULL;
+    }
+
+static int __tb_verify_all (void)
+    {
+    static const size_t sizes [] = { 1, 2, 3, 8, 64, 1000 };
+    size_t              t;
+    size_t              i;
+    int                 ret = 0;
+
+    for (t = 0; t < ARRAY_SIZE (tb_ops); t++)
+        {
+        for (i = 0; i < ARRAY_SIZE (sizes); i++)
+            {
+            ret |= __tb_verify (&tb_ops [t], sizes [i], sizes [i] * 20);
+            }
+        }
+
+    return ret;
+    }
+
+static int __tb_bench (size_t max, size_t lookups)
+    {
+    uintptr_t      * keys;
+    uint32_t       * probes;
+    struct tb_result avl;
+    struct tb_result rb;
+    struct tb_result crb;
+    size_t           nr;
+    size_t           i;
+
+    keys   = malloc (sizeof (uintptr_t) * max);
+    probes = malloc (sizeof (uint32_t) * lookups);
+
+    if ((keys == NULL) || (probes == NULL))
+        {
+        return 1;
+        }
+
+    printf ("%8s %5s %8s %8s %8s %8s %6s   (ns per operation)\n", "nodes",
+            "tree", "insert", "find_eq", "find_ge", "update", "height");
+
+    for (nr = 1000; nr <= max; nr *= 10)
+        {
+
+        /* unique even keys, shuffled */
+
+        for (i = 0; i < nr; i++)
+            {
+            keys [i] = (uintptr_t) i * 8 * (0xffffffffu / 8 / nr);
+            }
+
+        for (i = nr - 1; i > 0; i--)
+            {
+            size_t    j   = __tb_rand () % (i + 1);
+            uintptr_t tmp = keys [i];
+
+            keys [i] = keys [j];
+            keys [j] = tmp;
+            }
+
+        for (i = 0; i < lookups; i++)
+            {
+            probes [i] = __tb_rand () >> 1;
+            }
+
+        __tb_avl (keys, probes, nr, lookups, &avl);
+        __tb_rb  (keys, probes, nr, lookups, &rb);
+        __tb_crb (keys, probes, nr, lookups, &crb);
+
+        printf ("%8u %5s %8.1f %8.1f %8.1f %8.1f %6d\n", (unsigned int) nr,
+                "avl", avl.insert, avl.find_eq, avl.find_ge, avl.update,
+                avl.height);
+        printf ("%8s %5s %8.1f %8.1f %8.1f %8.1f %6d\n", "", "rb",
+                rb.insert, rb.find_eq, rb.find_ge, rb.update, rb.height);
+        printf ("%8s %5s %8.1f %8.1f %8.1f %8.1f %6d\n", "", "crb",
+                crb.insert, crb.find_eq, crb.find_ge, crb.update, crb.height);
+        }
+
+    free (keys);
+    free (probes);
+
+    return 0;
+    }
+
+int main (int argc, char * argv [])
+    {
+    const char * mode    = "all";
+    size_t       max     = TB_DEF_NODES;
+    size_t       lookups = TB_DEF_LOOKUPS;
+    int          opt;
+    int          ret     = 0;
+
+    while ((opt = getopt (argc, argv, "m:n:l:S:")) != -1)
+        {
+        switch (opt)
+            {
+            case 'm': mode    = optarg;                     break;
+            case 'n': max     = strtoul (optarg, NULL, 0);  break;
+            case 'l': lookups = strtoul (optarg, NULL, 0);  break;
+            case 'S': tb_seed = strtoul (optarg, NULL, 0);  break;
+            default:
+                fprintf (stderr, "usage: %s [-m verify|bench|all] "
+                         "[-n max_nodes] [-l lookups] [-S seed]\n", argv [0]);
+                return 1;
+            }
+        }
+
+    if ((max == 0) || (lookups == 0) || (tb_seed == 0))
+        {
+        return 1;
+        }
+
+    if (!strcmp (mode, "all") || !strcmp (mode, "verify"))
+        {
+        ret |= __tb_verify_all ();
+        }
+
+    if (!strcmp (mode, "all") || !strcmp (mode, "bench"))
+        {
+        ret |= __tb_bench (max, lookups);
+        }
+
+    return ret;
+    }
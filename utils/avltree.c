@@ -0,0 +1,599 @@
+/* avltree.c - avl tree implementation */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+the heights of the two sub-trees of any node differ by at most one, so an avl
+tree is never deeper than 1.44 log2 (n), compared to 2 log2 (n) of a red black
+tree, lookups are faster, while insertions and deletions may rotate more. use
+it for indexes searched much more often than updated.
+*/
+
+#include <stdbool.h>
+
+#include <wheel/avltree.h>
+
+/* inlines */
+
+/**
+ * __parent - get the parent of a node
+ * @n: the given node
+ *
+ * return: NA
+ */
+
+static inline avl_node_t * __parent (avl_node_t * n)
+    {
+    return container_of (n->bin.p, avl_node_t, bin);
+    }
+
+/**
+ * __left - get the left child of a node
+ * @n: the given node
+ *
+ * return: NA
+ */
+
+static inline avl_node_t * __left (avl_node_t * n)
+    {
+    return container_of (n->bin.l, avl_node_t, bin);
+    }
+
+/**
+ * __right - get the right child of a node
+ * @n: the given node
+ *
+ * return: NA
+ */
+
+static inline avl_node_t * __right (avl_node_t * n)
+    {
+    return container_of (n->bin.r, avl_node_t, bin);
+    }
+
+/**
+ * __set_parent - set the parent of a node
+ * @n: the given node
+ * @p: the new parent
+ *
+ * return: NA
+ */
+
+static inline void __set_parent (avl_node_t * n, avl_node_t * p)
+    {
+    n->bin.p = &p->bin;
+    }
+
+/**
+ * __set_left - set the left child of a node
+ * @n: the given node
+ * @l: the new left child
+ *
+ * return: NA
+ */
+
+static inline void __set_left (avl_node_t * n, avl_node_t * l)
+    {
+    n->bin.l = &l->bin;
+    }
+
+/**
+ * __set_right - set the right child of a node
+ * @n: the given node
+ * @r: the new right child
+ *
+ * return: NA
+ */
+
+static inline void __set_right (avl_node_t * n, avl_node_t * r)
+    {
+    n->bin.r = &r->bin;
+    }
+
+/**
+ * __set_root - set the root of a tree
+ * @n: the given tree
+ * @r: the new root
+ *
+ * return: NA
+ */
+
+static inline void __set_root (avl_tree_t * t, avl_node_t * r)
+    {
+    t->bit.r = &r->bin;
+    }
+
+/**
+ * __height - get the height of a node
+ * @n: the given node
+ *
+ * return: the height of <n>, 0 if <n> is NULL
+ */
+
+static inline int __height (avl_node_t * n)
+    {
+    return n == NULL ? 0 : n->height;
+    }
+
+/**
+ * __update_height - update the height of a node from its children
+ * @n: the given node
+ *
+ * return: NA
+ */
+
+static inline void __update_height (avl_node_t * n)
+    {
+    int lh = __height (__left (n));
+    int rh = __height (__right (n));
+
+    n->height = (lh > rh ? lh : rh) + 1;
+    }
+
+/**
+ * __rotate_right - rotate the sub-tree right and update the heights
+ * @t: the given tree
+ * @n: the given node (indcated the sub-tree)
+ *
+ * return: the new root of the sub-tree
+ */
+
+static inline avl_node_t * __rotate_right (avl_tree_t * t, avl_node_t * n)
+    {
+    __bit_rotate_right (&t->bit, &n->bin);
+
+    __update_height (n);
+
+    n = __parent (n);
+
+    __update_height (n);
+
+    return n;
+    }
+
+/**
+ * __rotate_left - rotate the sub-tree left and update the heights
+ * @t: the given tree
+ * @n: the given node (indcated the sub-tree)
+ *
+ * return: the new root of the sub-tree
+ */
+
+static inline avl_node_t * __rotate_left (avl_tree_t * t, avl_node_t * n)
+    {
+    __bit_rotate_left (&t->bit, &n->bin);
+
+    __update_height (n);
+
+    n = __parent (n);
+
+    __update_height (n);
+
+    return n;
+    }
+
+/**
+ * __successor - the successor node of a node
+ * @n: the given node
+ *
+ * return: the successor of <n>
+ */
+
+static inline avl_node_t * __successor (avl_node_t * n)
+    {
+    return container_of (__bit_successor (&n->bin), avl_node_t, bin);
+    }
+
+/**
+ * __predecessor - the predecessor node of a node
+ * @n: the given node
+ *
+ * return: the predecessor of <n>
+ */
+
+static inline avl_node_t * __predecessor (avl_node_t * n)
+    {
+    return container_of (__bit_predecessor (&n->bin), avl_node_t, bin);
+    }
+
+/**
+ * avl_find_eq - find a given key in an avl-tree
+ * @t: the given tree
+ * @k: the key value
+ *
+ * return: the node with key = <k>, NULL or key not found.
+ */
+
+avl_node_t * avl_find_eq (avl_tree_t * t, uintptr_t k)
+    {
+    return container_of (__bit_find_eq (&t->bit, k), avl_node_t, bin);
+    }
+
+/**
+ * avl_find_ge - find a node that is just greater or equal to the given value
+ * @t: the given tree
+ * @k: the key value
+ *
+ * return: the nearest node with key >= <k>, NULL or key not found.
+ */
+
+avl_node_t * avl_find_ge (avl_tree_t * t, uintptr_t k)
+    {
+    return container_of (__bit_find_ge (&t->bit, k), avl_node_t, bin);
+    }
+
+/**
+ * avl_find_gt - find a node that is just greater to the given value
+ * @t: the given tree
+ * @k: the key value
+ *
+ * return: the nearest node with key > <k>, NULL or key not found.
+ */
+
+avl_node_t * avl_find_gt (avl_tree_t * t, uintptr_t k)
+    {
+    return container_of (__bit_find_gt (&t->bit, k), avl_node_t, bin);
+    }
+
+/**
+ * avl_find_le - find a node that is just less or equal to the given value
+ * @t: the given tree
+ * @k: the key value
+ *
+ * return: the nearest node with key <= <k>, NULL or key not found.
+ */
+
+avl_node_t * avl_find_le (avl_tree_t * t, uintptr_t k)
+    {
+    return container_of (__bit_find_le (&t->bit, k), avl_node_t, bin);
+    }
+
+/**
+ * avl_find_lt - find a node that is just less to the given value
+ * @t: the given tree
+ * @k: the key value
+ *
+ * return: the nearest node with key < <k>, NULL or key not found.
+ */
+
+avl_node_t * avl_find_lt (avl_tree_t * t, uintptr_t k)
+    {
+    return container_of (__bit_find_lt (&t->bit, k), avl_node_t, bin);
+    }
+
+/**
+ * avl_first - find the first node of the tree
+ * @t: the given tree
+ *
+ * return: the first node, or NULL if the tree is empty
+ */
+
+avl_node_t * avl_first (avl_tree_t * t)
+    {
+    return container_of (__bit_first (&t->bit), avl_node_t, bin);
+    }
+
+/**
+ * avl_last - find the last node of the tree
+ * @t: the given tree
+ *
+ * return: the last node, or NULL if the tree is empty
+ */
+
+avl_node_t * avl_last (avl_tree_t * t)
+    {
+    return container_of (__bit_last (&t->bit), avl_node_t, bin);
+    }
+
+/**
+ * avl_next - find the next node
+ * @t: the given node
+ *
+ * return: the next node, or NULL if the node is already last
+ */
+
+avl_node_t * avl_next (avl_node_t * n)
+    {
+    return __successor (n);
+    }
+
+/**
+ * avl_prev - find the prevous node
+ * @t: the given node
+ *
+ * return: the prevous node, or NULL if the node is already first
+ */
+
+avl_node_t * avl_prev (avl_node_t * n)
+    {
+    return __predecessor (n);
+    }
+
+/**
+ * avl_replace - replace a new node in the same place
+ * @t: the given tree
+ * @o: the old node to be replaced
+ * @n: the new node
+ *
+ * return: NA
+ */
+
+void avl_replace (avl_tree_t * t, avl_node_t * o, avl_node_t * n)
+    {
+    avl_node_t * p, * l, * r;
+
+    *n = *o;
+
+    p = __parent (n);
+    l = __left (n);
+    r = __right (n);
+
+    if (l)
+        {
+        __set_parent (l, n);
+        }
+
+    if (r)
+        {
+        __set_parent (r, n);
+        }
+
+    if (!p)
+        {
+        t->bit.r = &n->bin;
+        return;
+        }
+
+    if (__left (p) == o)
+        {
+        __set_left (p, n);
+        }
+    else
+        {
+        __set_right (p, n);
+        }
+    }
+
+/**
+ * __avl_rebalance - update the heights and re-balance a tree from a node up to
+ *                   the root, after a node inserted or deleted under it
+ * @t: the given tree
+ * @n: the lowest node whose sub-tree changed
+ *
+ * return: NA
+ */
+
+static void __avl_rebalance (avl_tree_t * t, avl_node_t * n)
+    {
+    avl_node_t * c;
+    int          old;
+    int          diff;
+
+    while (n != NULL)
+        {
+        old  = n->height;
+        diff = __height (__left (n)) - __height (__right (n));
+
+        if (diff > 1)
+            {
+            c = __left (n);
+
+            /* left-right case, make it left-left first */
+
+            if (__height (__left (c)) < __height (__right (c)))
+                {
+                (void) __rotate_left (t, c);
+                }
+
+            n = __rotate_right (t, n);
+            }
+        else if (diff < -1)
+            {
+            c = __right (n);
+
+            /* right-left case, make it right-right first */
+
+            if (__height (__right (c)) < __height (__left (c)))
+                {
+                (void) __rotate_right (t, c);
+                }
+
+            n = __rotate_left (t, n);
+            }
+        else
+            {
+            __update_height (n);
+            }
+
+        /*
+         * the sub-tree keeps the height it had, the nodes above are not
+         * affected, this always stops an insertion after the first rotation
+         */
+
+        if (n->height == old)
+            {
+            return;
+            }
+
+        n = __parent (n);
+        }
+    }
+
+/**
+ * avl_insert - insert a new node into a tree
+ * @t: the given tree
+ * @n: the new inserted node
+ *
+ * return: 0 insert done, -1 insert fail (for double insertion)
+ */
+
+int avl_insert (avl_tree_t * t, avl_node_t * n)
+    {
+    n->height = 1;
+
+    if (__bit_insert (&t->bit, &n->bin) < 0)
+        {
+        return -1;
+        }
+
+    __avl_rebalance (t, __parent (n));
+
+    return 0;
+    }
+
+/**
+ * avl_node_get - find a existing node or create a new one for it
+ * @r:      the given tree root
+ * @k:      the key value
+ * @create: the node creating routine, <k> is the seconde argument
+ * @arg:    the first argument of the <create> routine
+ *
+ * return: the node with key = <k>, or NULL if node not found and allocate fail.
+ */
+
+avl_node_t * avl_node_get (avl_tree_t * t, uintptr_t k,
+                           bi_node_t * (* create) (uintptr_t, uintptr_t),
+                           uintptr_t arg)
+    {
+    avl_node_t * n;
+    bool         new = false;
+
+    n = container_of (__bit_node_get (&t->bit, k, &new, create, arg),
+                      avl_node_t, bin);
+
+    if (new)
+        {
+        n->height = 1;
+
+        __avl_rebalance (t, __parent (n));
+        }
+
+    return n;
+    }
+
+/**
+ * avl_delete - delete a node from a tree
+ * @t: the given tree
+ * @n: the node to be deleted
+ *
+ * return: NA
+ */
+
+void avl_delete (avl_tree_t * t, avl_node_t * n)
+    {
+    avl_node_t * p;
+    avl_node_t * c;
+    avl_node_t * o = n;
+    bool         two_child = false;
+
+    if ((t == NULL) || (n == NULL))
+        {
+        return;
+        }
+
+    /* find the real 'n' to be unlinked, and its child */
+
+    if (__right (n) == NULL)
+        {
+        c = __left (n);
+        }
+    else if (__left (n) == NULL)
+        {
+        c = __right (n);
+        }
+    else
+        {
+        two_child = true;
+
+        n = __successor (n);
+
+        /* n->left must be NIL, so n's child must be right (also may be NIL) */
+
+        c = __right (n);
+        }
+
+    p = __parent (n);
+
+    if ((c != NULL) && (p != o))
+        {
+        __set_parent (c, p);
+        }
+
+    if (unlikely (p == NULL))
+        {
+        __set_root (t, c);
+        }
+    else if (__left (p) == n)
+        {
+        __set_left (p, c);      /* set even p == o */
+        }
+    else
+        {
+        __set_right (p, c);     /* set even p == o */
+        }
+
+    if (two_child)
+        {
+        avl_node_t * op = __parent (o);
+
+        /* 'n' will take the place (and the height) of the old node 'o' */
+
+        *n = *o;
+
+        if (op != NULL)
+            {
+            if (__left (op) == o)
+                {
+                __set_left (op, n);
+                }
+            else
+                {
+                __set_right (op, n);
+                }
+            }
+        else
+            {
+            __set_root (t, n);
+            }
+
+        __set_parent (__left (n), n);
+
+        /* __right (n) is NULL when p == o and n had no child, see rb_delete */
+
+        if (__right (n) != NULL)
+            {
+            __set_parent (__right (n), n);
+            }
+
+        if (p == o)
+            {
+            p = n;
+            }
+        }
+
+    __avl_rebalance (t, p);
+    }
+
+/**
+ * avl_init - init an avl-tree
+ * @t: the given tree
+ * @c: the comparison method
+ * @k: the method to get the key of a node
+ *
+ * return: NA
+ */
+
+void avl_init (avl_tree_t * t,
+               int (* compare_nn) (bi_node_t *, bi_node_t *),
+               int (* compare_nk) (bi_node_t *, uintptr_t))
+    {
+    __bit_init (&t->bit, compare_nn, compare_nk);
+    }
@@ -0,0 +1,630 @@
+/* crbtree.c - compact red black tree implementation */
+
+/*
+ * Copyright (c) 2026 Fangming Chai
+ */
+
+/*
+modification history
+--------------------
+01a,19oct26,cfm  writen
+*/
+
+/*
+the re-balancing part of the compact red black tree, shared by all the trees
+generated with CRB_GENERATE, see crbtree.h. the algorithms are the same as
+rbtree.c, but the successor takes the place of a deleted node with two
+children by relinking, not by copying, as the nodes are embedded in the user
+structs.
+*/
+
+#include <stdbool.h>
+
+#include <wheel/crbtree.h>
+
+/* inlines */
+
+/**
+ * __color - get the color of a given node
+ * @n: the given node
+ *
+ * return: the color of <n>
+ */
+
+static inline int __color (crb_node_t * n)
+    {
+    return (int) (n->pc & 1);
+    }
+
+/**
+ * __is_red - check if a node is red
+ * @n: the given node
+ *
+ * return: true if <n> is red, false if not, or <n> is NULL.
+ */
+
+static inline bool __is_red (crb_node_t * n)
+    {
+    return (n != NULL) && (__color (n) == CRBTREE_RED);
+    }
+
+/**
+ * __is_black - check if a node is black
+ * @n: the given node
+ *
+ * return: true if <n> is black or NULL, false otherwise.
+ */
+
+static inline bool __is_black (crb_node_t * n)
+    {
+    return (n == NULL) || (__color (n) == CRBTREE_BLACK);
+    }
+
+/**
+ * __set_color - set a node's color
+ * @n: the given node
+ * @c: the new color
+ *
+ * return: NA
+ */
+
+static inline void __set_color (crb_node_t * n, int c)
+    {
+    n->pc = (n->pc & ~(uintptr_t) 1) | (uintptr_t) c;
+    }
+
+/**
+ * __set_parent - set the parent of a node, keep the color
+ * @n: the given node
+ * @p: the new parent
+ *
+ * return: NA
+ */
+
+static inline void __set_parent (crb_node_t * n, crb_node_t * p)
+    {
+    n->pc = (uintptr_t) p | (n->pc & 1);
+    }
+
+/**
+ * __change_child - replace the child of a parent (or the root)
+ * @t: the given tree
+ * @p: the parent, NULL if <o> is the root
+ * @o: the old child
+ * @n: the new child
+ *
+ * return: NA
+ */
+
+static inline void __change_child (crb_root_t * t, crb_node_t * p,
+                                   crb_node_t * o, crb_node_t * n)
+    {
+    if (p == NULL)
+        {
+        t->r = n;
+        }
+    else if (p->l == o)
+        {
+        p->l = n;
+        }
+    else
+        {
+        p->r = n;
+        }
+    }
+
+/**
+ * __rotate_left - rotate the sub-tree left
+ * @t:   the given tree
+ * @n:   the given node (indcated the sub-tree)
+ * @aug: the augment callbacks, or NULL
+ *
+ *    n                  a
+ *   / \                / \
+ *  x   a      ->      n   y
+ *     / \            / \
+ *    z   y          x   z
+ *
+ * return: NA
+ */
+
+static inline void __rotate_left (crb_root_t * t, crb_node_t * n,
+                                  const crb_augment_t * aug)
+    {
+    crb_node_t * a = n->r;
+    crb_node_t * p = crb_parent (n);
+
+    n->r = a->l;
+
+    if (a->l != NULL)
+        {
+        __set_parent (a->l, n);
+        }
+
+    a->l = n;
+
+    __set_parent (n, a);
+    __set_parent (a, p);
+    __change_child (t, p, n, a);
+
+    /* <a> holds the same nodes <n> held, only <n> and <a> need updating */
+
+    if (aug != NULL)
+        {
+        (void) aug->update (n);
+        (void) aug->update (a);
+        }
+    }
+
+/**
+ * __rotate_right - rotate the sub-tree right
+ * @t:   the given tree
+ * @n:   the given node (indcated the sub-tree)
+ * @aug: the augment callbacks, or NULL
+ *
+ *      n              a
+ *     / \            / \
+ *    a   x    ->    y   n
+ *   / \                / \
+ *  y   z              z   x
+ *
+ * return: NA
+ */
+
+static inline void __rotate_right (crb_root_t * t, crb_node_t * n,
+                                   const crb_augment_t * aug)
+    {
+    crb_node_t * a = n->l;
+    crb_node_t * p = crb_parent (n);
+
+    n->l = a->r;
+
+    if (a->r != NULL)
+        {
+        __set_parent (a->r, n);
+        }
+
+    a->r = n;
+
+    __set_parent (n, a);
+    __set_parent (a, p);
+    __change_child (t, p, n, a);
+
+    if (aug != NULL)
+        {
+        (void) aug->update (n);
+        (void) aug->update (a);
+        }
+    }
+
+/**
+ * crb_last - find the last node of the tree
+ * @t: the given tree
+ *
+ * return: the last node, or NULL if the tree is empty
+ */
+
+crb_node_t * crb_last (crb_root_t * t)
+    {
+    crb_node_t * n = t->r;
+
+    if (n != NULL)
+        {
+        while (n->r != NULL)
+            {
+            n = n->r;
+            }
+        }
+
+    return n;
+    }
+
+/**
+ * crb_next - find the next node
+ * @n: the given node
+ *
+ * return: the next node, or NULL if the node is already last
+ */
+
+crb_node_t * crb_next (crb_node_t * n)
+    {
+    crb_node_t * p;
+
+    if (n->r != NULL)
+        {
+        n = n->r;
+
+        while (n->l != NULL)
+            {
+            n = n->l;
+            }
+
+        return n;
+        }
+
+    while (((p = crb_parent (n)) != NULL) && (n == p->r))
+        {
+        n = p;
+        }
+
+    return p;
+    }
+
+/**
+ * crb_prev - find the prevous node
+ * @n: the given node
+ *
+ * return: the prevous node, or NULL if the node is already first
+ */
+
+crb_node_t * crb_prev (crb_node_t * n)
+    {
+    crb_node_t * p;
+
+    if (n->l != NULL)
+        {
+        n = n->l;
+
+        while (n->r != NULL)
+            {
+            n = n->r;
+            }
+
+        return n;
+        }
+
+    while (((p = crb_parent (n)) != NULL) && (n == p->l))
+        {
+        n = p;
+        }
+
+    return p;
+    }
+
+/**
+ * crb_replace - replace a node with a new one of the same key in the same place
+ * @t: the given tree
+ * @o: the old node to be replaced
+ * @n: the new node
+ *
+ * return: NA
+ */
+
+void crb_replace (crb_root_t * t, crb_node_t * o, crb_node_t * n)
+    {
+    *n = *o;
+
+    if (n->l != NULL)
+        {
+        __set_parent (n->l, n);
+        }
+
+    if (n->r != NULL)
+        {
+        __set_parent (n->r, n);
+        }
+
+    __change_child (t, crb_parent (n), o, n);
+
+    if (t->first == o)
+        {
+        t->first = n;
+        }
+    }
+
+/**
+ * crb_insert_color - re-balance the tree after a node linked by crb_link
+ * @t:   the given tree
+ * @n:   the new linked node
+ * @aug: the augment callbacks, or NULL
+ *
+ * return: NA
+ */
+
+void crb_insert_color (crb_root_t * t, crb_node_t * n,
+                       const crb_augment_t * aug)
+    {
+    crb_node_t * p;
+    crb_node_t * g;
+    crb_node_t * u;
+
+    /*
+     * the nodes on the path to the root get a new descendant, stop as soon as
+     * one of them does not change, the rotations below keep the data right
+     */
+
+    if (aug != NULL)
+        {
+        (void) aug->update (n);
+
+        for (p = crb_parent (n); p != NULL; p = crb_parent (p))
+            {
+            if (!aug->update (p))
+                {
+                break;
+                }
+            }
+        }
+
+    while (__is_red (p = crb_parent (n)))
+        {
+
+        /* the parent is red, so it is not the root, the grand parent is black */
+
+        g = crb_parent (p);
+
+        if (p == g->l)
+            {
+            u = g->r;
+
+            if (__is_red (u))
+                {
+
+                /* case 1: the uncle is red */
+
+                __set_color (p, CRBTREE_BLACK);
+                __set_color (u, CRBTREE_BLACK);
+                __set_color (g, CRBTREE_RED);
+
+                n = g;
+                continue;
+                }
+
+            /* case 2: n is the right child, make it case 3 */
+
+            if (n == p->r)
+                {
+                __rotate_left (t, p, aug);
+
+                n = p;
+                p = crb_parent (n);
+                }
+
+            /* case 3: n is the left child */
+
+            __set_color (p, CRBTREE_BLACK);
+            __set_color (g, CRBTREE_RED);
+
+            __rotate_right (t, g, aug);
+            }
+        else
+            {
+            u = g->l;
+
+            if (__is_red (u))
+                {
+                __set_color (p, CRBTREE_BLACK);
+                __set_color (u, CRBTREE_BLACK);
+                __set_color (g, CRBTREE_RED);
+
+                n = g;
+                continue;
+                }
+
+            if (n == p->l)
+                {
+                __rotate_right (t, p, aug);
+
+                n = p;
+                p = crb_parent (n);
+                }
+
+            __set_color (p, CRBTREE_BLACK);
+            __set_color (g, CRBTREE_RED);
+
+            __rotate_left (t, g, aug);
+            }
+        }
+
+    __set_color (t->r, CRBTREE_BLACK);
+    }
+
+/**
+ * __crb_erase_color - re-balance a tree after unlinking a black node
+ * @t:   the given tree
+ * @n:   the double black node, may be NULL
+ * @p:   the parent of <n>
+ * @aug: the augment callbacks, or NULL
+ *
+ * return: NA
+ */
+
+static void __crb_erase_color (crb_root_t * t, crb_node_t * n, crb_node_t * p,
+                               const crb_augment_t * aug)
+    {
+    crb_node_t * w;
+
+    /* <n> is double black, so its sibling <w> must not be NULL */
+
+    while ((n != t->r) && __is_black (n))
+        {
+        if (n == p->l)
+            {
+            w = p->r;
+
+            if (__is_red (w))
+                {
+
+                /* case 1: the sibling w is red */
+
+                __set_color (w, CRBTREE_BLACK);
+                __set_color (p, CRBTREE_RED);
+
+                __rotate_left (t, p, aug);
+
+                w = p->r;
+                }
+
+            if (__is_black (w->l) && __is_black (w->r))
+                {
+
+                /* case 2: w is black, and both of w's children are black */
+
+                __set_color (w, CRBTREE_RED);
+
+                n = p;
+                p = crb_parent (n);
+
+                continue;
+                }
+
+            if (__is_black (w->r))
+                {
+
+                /* case 3: w's left child is red, and the right one is black */
+
+                __set_color (w->l, CRBTREE_BLACK);
+                __set_color (w, CRBTREE_RED);
+
+                __rotate_right (t, w, aug);
+
+                w = p->r;
+                }
+
+            /* case 4: w is black, and w's right child is red */
+
+            __set_color (w, __color (p));
+            __set_color (p, CRBTREE_BLACK);
+            __set_color (w->r, CRBTREE_BLACK);
+
+            __rotate_left (t, p, aug);
+            }
+        else
+            {
+            w = p->l;
+
+            if (__is_red (w))
+                {
+                __set_color (w, CRBTREE_BLACK);
+                __set_color (p, CRBTREE_RED);
+
+                __rotate_right (t, p, aug);
+
+                w = p->l;
+                }
+
+            if (__is_black (w->l) && __is_black (w->r))
+                {
+                __set_color (w, CRBTREE_RED);
+
+                n = p;
+                p = crb_parent (n);
+
+                continue;
+                }
+
+            if (__is_black (w->l))
+                {
+                __set_color (w->r, CRBTREE_BLACK);
+                __set_color (w, CRBTREE_RED);
+
+                __rotate_left (t, w, aug);
+
+                w = p->l;
+                }
+
+            __set_color (w, __color (p));
+            __set_color (p, CRBTREE_BLACK);
+            __set_color (w->l, CRBTREE_BLACK);
+
+            __rotate_right (t, p, aug);
+            }
+
+        n = t->r;
+        }
+
+    if (n != NULL)
+        {
+        __set_color (n, CRBTREE_BLACK);
+        }
+    }
+
+/**
+ * crb_erase - delete a node from a tree
+ * @t:   the given tree
+ * @n:   the node to be deleted
+ * @aug: the augment callbacks, or NULL
+ *
+ * return: NA
+ */
+
+void crb_erase (crb_root_t * t, crb_node_t * n, const crb_augment_t * aug)
+    {
+    crb_node_t * c;             /* the child taking the unlinked place */
+    crb_node_t * p;             /* parent of <c> */
+    crb_node_t * s;
+    int          color = __color (n);
+
+    if (t->first == n)
+        {
+        t->first = crb_next (n);
+        }
+
+    if ((n->l == NULL) || (n->r == NULL))
+        {
+        c = n->l != NULL ? n->l : n->r;
+        p = crb_parent (n);
+
+        if (c != NULL)
+            {
+            __set_parent (c, p);
+            }
+
+        __change_child (t, p, n, c);
+        }
+    else
+        {
+
+        /* the successor <s> has no left child, it takes the place of <n> */
+
+        s     = n->r;
+
+        while (s->l != NULL)
+            {
+            s = s->l;
+            }
+
+        color = __color (s);
+        c     = s->r;
+
+        if (crb_parent (s) == n)
+            {
+            p = s;
+            }
+        else
+            {
+            p = crb_parent (s);
+
+            if (c != NULL)
+                {
+                __set_parent (c, p);
+                }
+
+            p->l = c;
+
+            s->r = n->r;
+            __set_parent (s->r, s);
+            }
+
+        s->l  = n->l;
+        __set_parent (s->l, s);
+
+        s->pc = n->pc;          /* the parent and the color of <n> */
+        __change_child (t, crb_parent (n), n, s);
+        }
+
+    /* every node from <p> to the root lost a descendant */
+
+    if (aug != NULL)
+        {
+        for (s = p; s != NULL; s = crb_parent (s))
+            {
+            (void) aug->update (s);
+            }
+        }
+
+    if (color == CRBTREE_BLACK)
+        {
+        __crb_erase_color (t, c, p, aug);
+        }
+    }
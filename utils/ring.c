@@ -16,6 +16,8 @@ modification history
 #include <wheel/common.h>
 #include <wheel/ring.h>
 
+#include <arch/sync.h>
+
 /**
  * ring_init - initialize a predefined ring using preallocated buffer
  * @ring: the predefined ring to be used.
@@ -90,15 +92,16 @@ void ring_destroy (ring_t * ring)
         return;
         }
 
-    free (ring->buff);      /* it is ok to free (NULL) */
-    free (ring);
+    free (ring);            /* the buffer is in the same block */
     }
 
 /**
- * __ring_put - put data to a ring, and the free space is enough
+ * __ring_copy_in - copy data to the free space of a ring from <tail>, the free
+ *                  space is enough, the tail is not moved
  */
 
-static inline size_t __ring_put (ring_t * ring, unsigned char * buff, size_t len)
+static inline void __ring_copy_in (ring_t * ring, size_t tail,
+                                   unsigned char * buff, size_t len)
     {
     size_t tail_space;
     size_t mask = ring->size - 1;
@@ -108,7 +111,7 @@ static inline size_t __ring_put (ring_t * ring, unsigned char * buff, size_t len
      *               (size - tail & mask)
      */
 
-    tail_space = ring->size - (ring->tail & mask);
+    tail_space = ring->size - (tail & mask);
 
     if (len > tail_space)
         {
@@ -127,7 +130,7 @@ static inline size_t __ring_put (ring_t * ring, unsigned char * buff, size_t len
          * so there must be two free partitions, one in the front, one in the end
          */
 
-        memcpy (ring->buff + (ring->tail & mask), buff, tail_space);
+        memcpy (ring->buff + (tail & mask), buff, tail_space);
         memcpy (ring->buff, buff + tail_space, len - tail_space);
         }
     else
@@ -161,8 +164,17 @@ static inline size_t __ring_put (ring_t * ring, unsigned char * buff, size_t len
          * so it is still safe to copy <len> bytes
          */
 
-        memcpy (ring->buff + (ring->tail & mask), buff, len);
+        memcpy (ring->buff + (tail & mask), buff, len);
         }
+    }
+
+/**
+ * __ring_put - put data to a ring, and the free space is enough
+ */
+
+static inline size_t __ring_put (ring_t * ring, unsigned char * buff, size_t len)
+    {
+    __ring_copy_in (ring, ring->tail, buff, len);
 
     ring->tail += len;
 
@@ -252,30 +264,22 @@ size_t ring_putc_force (ring_t * ring, unsigned char byte)
     }
 
 /**
- * ring_get - get data from a ring
- * @ring: the ring which the data will be get from.
- * @buff: the data buffer.
- * @size: the max length of the data to get.
- *
- * return: the size of data actually got
+ * __ring_copy_out - copy data from a ring from <head>, there are enough data,
+ *                   the head is not moved
  */
 
-size_t ring_get (ring_t * ring, unsigned char * buff, size_t len)
+static inline void __ring_copy_out (ring_t * ring, size_t head,
+                                    unsigned char * buff, size_t len)
     {
-    size_t ring_data;
     size_t head_space;
     size_t mask = ring->size - 1;
 
     /*
-     * ring_data  => the data size in the ring
      * head_space => the space size from head to the end of the ring
      *               (size - head & mask)
      */
 
-    ring_data  = ring_len (ring);
-    head_space = ring->size - (ring->head & mask);
-
-    len = min (len, ring_data);
+    head_space = ring->size - (head & mask);
 
     if (len > head_space)
         {
@@ -294,7 +298,7 @@ size_t ring_get (ring_t * ring, unsigned char * buff, size_t len)
          * so there must be two data partitions, one in the front, one in the end
          */
 
-        memcpy (buff, ring->buff + (ring->head & mask), head_space);
+        memcpy (buff, ring->buff + (head & mask), head_space);
         memcpy (buff + head_space, ring->buff, len - head_space);
         }
     else
@@ -327,8 +331,24 @@ size_t ring_get (ring_t * ring, unsigned char * buff, size_t len)
          * so it is still safe to copy <len> bytes
          */
 
-        memcpy (buff, ring->buff + (ring->head & mask), len);
+        memcpy (buff, ring->buff + (head & mask), len);
         }
+    }
+
+/**
+ * ring_get - get data from a ring
+ * @ring: the ring which the data will be get from.
+ * @buff: the data buffer.
+ * @size: the max length of the data to get.
+ *
+ * return: the size of data actually got
+ */
+
+size_t ring_get (ring_t * ring, unsigned char * buff, size_t len)
+    {
+    len = min (len, ring_len (ring));
+
+    __ring_copy_out (ring, ring->head, buff, len);
 
     ring->head += len;
 
@@ -357,3 +377,132 @@ size_t ring_getc (ring_t * ring, unsigned char * byte)
     return 1;
     }
 
+
+/*
+ * the ring_spsc_* routines are lock-free for one producer (putting) and one
+ * consumer (getting) running concurrently, for example an isr and a task, or
+ * two tasks, without int_lock or mutex. only the producer writes the tail and
+ * only the consumer writes the head, each side publishes its index after the
+ * data with a barrier:
+ *
+ *   producer                            consumer
+ *
+ *   head = load (ring->head)            tail = load (ring->tail)
+ *   mb ()   <- the slots are read       rmb ()  <- the data is written
+ *   write data from tail                read data from head
+ *   wmb ()  <- before the new tail      mb ()   <- before the new head
+ *   store (ring->tail, tail + n)        store (ring->head, head + n)
+ *
+ * more producers (or consumers) must be serialized by the caller. the _force
+ * routines move the head, so they can not be used on a spsc ring.
+ */
+
+/**
+ * ring_spsc_put - put data to a ring by the only producer
+ * @ring: the ring which the data will be put in.
+ * @buff: the data buffer.
+ * @size: the length of the data.
+ *
+ * return: the size of data actually put
+ */
+
+size_t ring_spsc_put (ring_t * ring, unsigned char * buff, size_t len)
+    {
+    size_t tail = ring->tail;
+    size_t head = __ring_load (&ring->head);
+
+    mb ();
+
+    len = min (len, ring->size - (tail - head));
+
+    __ring_copy_in (ring, tail, buff, len);
+
+    wmb ();
+
+    __ring_store (&ring->tail, tail + len);
+
+    return len;
+    }
+
+/**
+ * ring_spsc_putc - put one byte to a ring by the only producer
+ * @ring: the ring which the data will be put in.
+ * @byte: the byte to be put in.
+ *
+ * return: the size of data actually put
+ */
+
+size_t ring_spsc_putc (ring_t * ring, unsigned char byte)
+    {
+    size_t tail = ring->tail;
+
+    if (tail - __ring_load (&ring->head) == ring->size)
+        {
+        return 0;
+        }
+
+    mb ();
+
+    ring->buff [tail & (ring->size - 1)] = byte;
+
+    wmb ();
+
+    __ring_store (&ring->tail, tail + 1);
+
+    return 1;
+    }
+
+/**
+ * ring_spsc_get - get data from a ring by the only consumer
+ * @ring: the ring which the data will be get from.
+ * @buff: the data buffer.
+ * @size: the max length of the data to get.
+ *
+ * return: the size of data actually got
+ */
+
+size_t ring_spsc_get (ring_t * ring, unsigned char * buff, size_t len)
+    {
+    size_t head = ring->head;
+    size_t tail = __ring_load (&ring->tail);
+
+    rmb ();
+
+    len = min (len, tail - head);
+
+    __ring_copy_out (ring, head, buff, len);
+
+    mb ();
+
+    __ring_store (&ring->head, head + len);
+
+    return len;
+    }
+
+/**
+ * ring_spsc_getc - get one byte from a ring by the only consumer
+ * @ring: the ring which the data will be get from.
+ * @byte: the address where store the byte.
+ *
+ * return: the size of data actually got
+ */
+
+size_t ring_spsc_getc (ring_t * ring, unsigned char * byte)
+    {
+    size_t head = ring->head;
+
+    if (__ring_load (&ring->tail) == head)
+        {
+        return 0;
+        }
+
+    rmb ();
+
+    *byte = ring->buff [head & (ring->size - 1)];
+
+    mb ();
+
+    __ring_store (&ring->head, head + 1);
+
+    return 1;
+    }